@@ -0,0 +1,57 @@
+// bench_common.c
+#include <stdio.h>
+
+#include "bench_common.h"
+
+int init_bench_window(const char* title, int width, int height, BenchWindow* bench) {
+    bench->window = NULL;
+    bench->gl_context = NULL;
+
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
+        fprintf(stderr, "Failed to init video! %s\n", SDL_GetError());
+        return 0;
+    }
+
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    bench->window = SDL_CreateWindow(title, width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if (!bench->window) {
+        printf("Error: SDL_CreateWindow(): %s\n", SDL_GetError());
+        SDL_Quit();
+        return 0;
+    }
+    bench->gl_context = SDL_GL_CreateContext(bench->window);
+    if (!bench->gl_context) {
+        printf("Error: SDL_GL_CreateContext(): %s\n", SDL_GetError());
+        cleanup_bench_window(bench);
+        return 0;
+    }
+    SDL_GL_MakeCurrent(bench->window, bench->gl_context);
+    SDL_GL_SetSwapInterval(0);
+
+    if (gladLoadGL((GLADloadfunc)SDL_GL_GetProcAddress) == 0) {
+        printf("Failed to initialize GLAD\n");
+        cleanup_bench_window(bench);
+        return 0;
+    }
+    printf("OpenGL loaded: version %s\n", glGetString(GL_VERSION));
+    glViewport(0, 0, width, height);
+    return 1;
+}
+
+void cleanup_bench_window(BenchWindow* bench) {
+    if (bench->gl_context) SDL_GL_DestroyContext(bench->gl_context);
+    if (bench->window) SDL_DestroyWindow(bench->window);
+    bench->gl_context = NULL;
+    bench->window = NULL;
+    SDL_Quit();
+}
+
+double bench_elapsed_ms(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+double bench_elapsed_seconds(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+}
@@ -0,0 +1,21 @@
+// bench_common.h
+#pragma once
+
+// Setup and timing shared by the benchmarks in bench/
+
+#include <SDL3/SDL.h>
+#include <glad/gl.h>
+
+typedef struct {
+    SDL_Window* window;
+    SDL_GLContext gl_context;
+} BenchWindow;
+
+// Hidden width x height window with a GL 3.3 core context, glad loaded and vsync off.
+// Returns 0 (everything cleaned up) on failure.
+int init_bench_window(const char* title, int width, int height, BenchWindow* bench);
+void cleanup_bench_window(BenchWindow* bench);
+
+// Time since a SDL_GetPerformanceCounter() value
+double bench_elapsed_ms(Uint64 start);
+double bench_elapsed_seconds(Uint64 start);
@@ -0,0 +1,95 @@
+// bench_cube_instancing.c
+// Sweep the cube count and compare per-entity draws against the instanced path
+// of render_3d_cube_system to find where instancing starts to pay off.
+
+#include <SDL3/SDL.h>
+#include <glad/gl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <cglm/cglm.h>
+#include "flecs.h"
+#include "module_transform3d.h"
+#include "module_camera.h"
+#include "bench_common.h"
+
+#define BENCH_FRAMES 100
+
+static const int cube_counts[] = { 1, 10, 100, 1000, 5000, 10000, 50000 };
+
+// Average frame time of ecs_progress (transform update + cube render) in ms
+static double time_frames(ecs_world_t* world) {
+    ecs_progress(world, 0); // Warm up: first frame computes the world matrices
+    glFinish();
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        ecs_progress(world, 0);
+    }
+    glFinish();
+    return bench_elapsed_ms(start) / BENCH_FRAMES;
+}
+
+int main(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+
+    BenchWindow bench;
+    if (!init_bench_window("Cube instancing benchmark", 1280, 720, &bench)) return 1;
+    set_camera_viewport(1280, 720);
+
+    CubeContext cube;
+    if (!init_cube_mesh(&cube)) {
+        cleanup_bench_window(&bench);
+        return -1;
+    }
+
+    printf("%8s %14s %14s %8s\n", "cubes", "per-entity ms", "instanced ms", "speedup");
+    for (size_t n = 0; n < sizeof(cube_counts) / sizeof(cube_counts[0]); n++) {
+        int count = cube_counts[n];
+
+        ecs_world_t* world = ecs_init();
+        register_transform3d(world);
+        register_camera(world);
+        ecs_set_ctx(world, &cube, NULL);
+
+        ecs_entity_t camera = ecs_new(world);
+        ecs_set(world, camera, Camera3D, {
+            .position = {0.0f, 0.0f, 5.0f},
+            .target = {0.0f, 0.0f, 0.0f},
+            .up = {0.0f, 1.0f, 0.0f},
+            .fov = 45.0f,
+            .nearPlane = 0.1f,
+            .farPlane = 100.0f,
+            .isDirty = true
+        });
+
+        // Grid of small cubes in front of the camera
+        int side = (int)ceilf(sqrtf((float)count));
+        float spacing = 4.0f / side;
+        for (int i = 0; i < count; i++) {
+            ecs_entity_t e = ecs_new(world);
+            float half = spacing * 0.5f;
+            set_transform3d(world, e,
+                (vec3){-2.0f + (i % side + 0.5f) * spacing, -2.0f + (i / side + 0.5f) * spacing, 0.0f},
+                (versor){0.0f, 0.0f, 0.0f, 1.0f},
+                (vec3){half, half, half});
+        }
+
+        cube.instanced = false;
+        double per_entity_ms = time_frames(world);
+        cube.instanced = true;
+        double instanced_ms = time_frames(world);
+
+        printf("%8d %14.3f %14.3f %7.2fx\n", count, per_entity_ms, instanced_ms, per_entity_ms / instanced_ms);
+        ecs_fini(world);
+    }
+
+    cleanup_cube_mesh(&cube);
+    cleanup_camera();
+
+    cleanup_bench_window(&bench);
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+// bench_text_batch.c
+// Compare labels/ms of per-call render_text against the batched text path.
+
+#include <SDL3/SDL.h>
+#include <glad/gl.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "module_font.h"
+#include "module_shader.h"
+#include "module_glstate.h"
+#include "bench_common.h"
+
+#define BENCH_FRAMES 200
+
+static const int label_counts[] = { 10, 100, 500, 1000, 2000 };
+
+int main(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+
+    BenchWindow bench;
+    if (!init_bench_window("Text batch benchmark", 1280, 720, &bench)) return 1;
+
+    FontData* font_data = NULL;
+    GLuint program, vao, vbo;
+    TextBatch* batch = NULL;
+    if (!init_font("resources/Kenney Mini.ttf", 16.0f, 1.0f, &font_data) ||
+        !init_font_shaders_and_buffers(&program, &vao, &vbo) ||
+        !init_text_batch(&batch)) {
+        cleanup_bench_window(&bench);
+        return -1;
+    }
+
+    const int ww = 1280, hh = 720;
+    glstate_enable(GL_BLEND);
+    glstate_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    printf("%8s %16s %16s %8s\n", "labels", "per-call lbl/ms", "batched lbl/ms", "speedup");
+    for (size_t n = 0; n < sizeof(label_counts) / sizeof(label_counts[0]); n++) {
+        int count = label_counts[n];
+        char label[32];
+
+        // Per-call path: one buffer upload and one draw per label
+        glFinish();
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            for (int i = 0; i < count; i++) {
+                snprintf(label, sizeof(label), "Label %d", i);
+                render_text(font_data, program, vao, vbo, label, (float)(i % 16) * 80.0f, 20.0f + (float)(i / 16 % 35) * 20.0f, ww, hh, 1.0f, 1.0f, 1.0f, 1.0f);
+            }
+        }
+        glFinish();
+        double per_call_ms = bench_elapsed_ms(start);
+
+        // Batched path: every label of the frame in one upload and one draw
+        start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            begin_text_batch(batch, ww, hh);
+            for (int i = 0; i < count; i++) {
+                snprintf(label, sizeof(label), "Label %d", i);
+                queue_text(batch, font_data, label, (float)(i % 16) * 80.0f, 20.0f + (float)(i / 16 % 35) * 20.0f, 1.0f, 1.0f, 1.0f, 1.0f);
+            }
+            flush_text_batch(batch);
+        }
+        glFinish();
+        double batched_ms = bench_elapsed_ms(start);
+
+        double labels = (double)count * BENCH_FRAMES;
+        printf("%8d %16.1f %16.1f %7.2fx\n", count, labels / per_call_ms, labels / batched_ms, per_call_ms / batched_ms);
+    }
+
+    cleanup_text_batch(batch);
+    cleanup_font(font_data);
+    release_shader_program(program);
+    glDeleteBuffers(1, &vbo);
+    glstate_delete_vertex_array(&vao);
+
+    cleanup_bench_window(&bench);
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+// bench_text_glyphs.c
+// Glyph throughput of render_text and the text batch for very long strings.
+
+#include <SDL3/SDL.h>
+#include <glad/gl.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "module_font.h"
+#include "module_shader.h"
+#include "module_glstate.h"
+#include "bench_common.h"
+
+#define BENCH_GLYPHS 2000000 // Glyphs drawn per measurement, frames = BENCH_GLYPHS / length
+
+static const int text_lengths[] = { 1000, 10000, 100000 };
+
+int main(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+
+    BenchWindow bench;
+    if (!init_bench_window("Text glyph benchmark", 1280, 720, &bench)) return 1;
+
+    FontData* font_data = NULL;
+    GLuint program, vao, vbo;
+    TextBatch* batch = NULL;
+    if (!init_font("resources/Kenney Mini.ttf", 16.0f, 1.0f, &font_data) ||
+        !init_font_shaders_and_buffers(&program, &vao, &vbo) ||
+        !init_text_batch(&batch)) {
+        cleanup_bench_window(&bench);
+        return -1;
+    }
+
+    const int ww = 1280, hh = 720;
+    glstate_enable(GL_BLEND);
+    glstate_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    printf("%8s %18s %18s\n", "glyphs", "render_text gl/ms", "batched gl/ms");
+    for (size_t n = 0; n < sizeof(text_lengths) / sizeof(text_lengths[0]); n++) {
+        int length = text_lengths[n];
+        int frames = BENCH_GLYPHS / length;
+
+        // Printable ASCII; the string runs off screen, which is fine for throughput
+        char* text = (char*)malloc(length + 1);
+        if (!text) break;
+        for (int i = 0; i < length; i++) text[i] = (char)(33 + i % 94);
+        text[length] = '\0';
+
+        glFinish();
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < frames; frame++) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            render_text(font_data, program, vao, vbo, text, 0.0f, 20.0f, ww, hh, 1.0f, 1.0f, 1.0f, 1.0f);
+        }
+        glFinish();
+        double render_ms = bench_elapsed_ms(start);
+
+        start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < frames; frame++) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            begin_text_batch(batch, ww, hh);
+            queue_text(batch, font_data, text, 0.0f, 20.0f, 1.0f, 1.0f, 1.0f, 1.0f);
+            flush_text_batch(batch);
+        }
+        glFinish();
+        double batched_ms = bench_elapsed_ms(start);
+
+        double glyphs = (double)length * frames;
+        printf("%8d %18.1f %18.1f\n", length, glyphs / render_ms, glyphs / batched_ms);
+        free(text);
+    }
+
+    cleanup_text_batch(batch);
+    cleanup_font(font_data);
+    release_shader_program(program);
+    glDeleteBuffers(1, &vbo);
+    glstate_delete_vertex_array(&vao);
+
+    cleanup_bench_window(&bench);
+
+    return 0;
+}
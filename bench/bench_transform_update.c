@@ -0,0 +1,197 @@
+// bench_transform_update.c
+// Transform update throughput: each compose_transforms kernel on plain arrays, then
+// update_transform_system on a flecs world (roots plus one child level), once with every
+// table changed and once with a static scene, and last the system on the job pool for
+// 1, 2, 4... threads against entity count and depth. No window needed.
+
+#include <SDL3/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cglm/cglm.h>
+#include "flecs.h"
+#include "module_transform3d.h"
+#include "module_transform_kernel.h"
+#include "module_jobs.h"
+#include "bench_common.h"
+
+#define BENCH_ENTITIES 1000000
+#define BENCH_REPEATS 20
+#define BENCH_CHILDREN_PER_PARENT 64
+
+static float random_float(float lo, float hi) {
+    return lo + (hi - lo) * (float)rand() / (float)RAND_MAX;
+}
+
+static void random_transform(Position3* position, Rotation* rotation, Scale3* scale) {
+    *position = (Position3){ random_float(-10.0f, 10.0f), random_float(-10.0f, 10.0f), random_float(-10.0f, 10.0f) };
+    versor q = { random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f) };
+    glm_quat_normalize(q);
+    *rotation = (Rotation){ q[0], q[1], q[2], q[3] };
+    *scale = (Scale3){ random_float(0.5f, 2.0f), random_float(0.5f, 2.0f), random_float(0.5f, 2.0f) };
+}
+
+// Millions of entities per second for the selected kernel
+static double time_kernel(const Position3* positions, const Rotation* rotations, const Scale3* scales,
+                          const WorldMatrix* parent, WorldMatrix* out, int count) {
+    compose_transforms(positions, rotations, scales, parent, out, count); // Warm up
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+        compose_transforms(positions, rotations, scales, parent, out, count);
+    }
+    return (double)count * BENCH_REPEATS / bench_elapsed_seconds(start) / 1e6;
+}
+
+static void bench_kernels(void) {
+    Position3* positions = (Position3*)malloc(BENCH_ENTITIES * sizeof(Position3));
+    Rotation* rotations = (Rotation*)malloc(BENCH_ENTITIES * sizeof(Rotation));
+    Scale3* scales = (Scale3*)malloc(BENCH_ENTITIES * sizeof(Scale3));
+    WorldMatrix* worlds = (WorldMatrix*)malloc(BENCH_ENTITIES * sizeof(WorldMatrix));
+    if (!positions || !rotations || !scales || !worlds) {
+        printf("Error: Out of memory\n");
+        free(positions);
+        free(rotations);
+        free(scales);
+        free(worlds);
+        return;
+    }
+    for (int i = 0; i < BENCH_ENTITIES; i++) random_transform(&positions[i], &rotations[i], &scales[i]);
+    WorldMatrix parent = {{ { 0.0f, -1.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f, 2.0f }, { 0.0f, 0.0f, 1.0f, 3.0f } }};
+
+    TransformKernel best = get_transform_kernel();
+    printf("%-8s %16s %16s\n", "kernel", "roots M/s", "children M/s");
+    for (int kernel = 0; kernel < TRANSFORM_KERNEL_COUNT; kernel++) {
+        if (!select_transform_kernel((TransformKernel)kernel)) {
+            printf("%-8s %16s\n", transform_kernel_name((TransformKernel)kernel), "unsupported");
+            continue;
+        }
+        double roots = time_kernel(positions, rotations, scales, NULL, worlds, BENCH_ENTITIES);
+        double children = time_kernel(positions, rotations, scales, &parent, worlds, BENCH_ENTITIES);
+        printf("%-8s %16.1f %16.1f\n", transform_kernel_name((TransformKernel)kernel), roots, children);
+    }
+    select_transform_kernel(best);
+
+    free(positions);
+    free(rotations);
+    free(scales);
+    free(worlds);
+}
+
+// Seconds for BENCH_REPEATS runs of the system. With touch set, one root is modified before
+// each run (outside the timing): the roots table changes, so every child table follows.
+static double time_system(ecs_world_t* world, ecs_entity_t system, ecs_entity_t touch) {
+    double seconds = 0.0;
+    for (int repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+        if (touch) ecs_modified(world, touch, Position3);
+        Uint64 start = SDL_GetPerformanceCounter();
+        ecs_run(world, system, 0.0f, NULL);
+        seconds += bench_elapsed_seconds(start);
+    }
+    return seconds;
+}
+
+// New entity with a random transform, a root when parent is 0
+static ecs_entity_t add_random_entity(ecs_world_t* world, ecs_entity_t parent) {
+    Position3 position;
+    Rotation rotation;
+    Scale3 scale;
+    ecs_entity_t entity = parent ? ecs_new_w_pair(world, EcsChildOf, parent) : ecs_new(world);
+    random_transform(&position, &rotation, &scale);
+    set_transform3d(world, entity, (vec3){ position.x, position.y, position.z },
+                    (versor){ rotation.x, rotation.y, rotation.z, rotation.w }, (vec3){ scale.x, scale.y, scale.z });
+    return entity;
+}
+
+// Children of parent, fanout per entity, levels deep; returns how many were created
+static int add_subtree(ecs_world_t* world, ecs_entity_t parent, int levels, int fanout) {
+    if (levels == 0) return 0;
+    int count = 0;
+    for (int c = 0; c < fanout; c++) {
+        ecs_entity_t child = add_random_entity(world, parent);
+        count += 1 + add_subtree(world, child, levels - 1, fanout);
+    }
+    return count;
+}
+
+// About entities entities as trees depth levels deep (roots included); returns the first root
+static ecs_entity_t build_scene(ecs_world_t* world, int entities, int depth, int fanout, int* total) {
+    int per_tree = 1;
+    for (int level = 1, width = 1; level < depth; level++) {
+        width *= fanout;
+        per_tree += width;
+    }
+    int roots = entities / per_tree > 0 ? entities / per_tree : 1;
+
+    ecs_entity_t first_root = 0;
+    *total = 0;
+    for (int r = 0; r < roots; r++) {
+        ecs_entity_t root = add_random_entity(world, 0);
+        if (!first_root) first_root = root;
+        *total += 1 + add_subtree(world, root, depth - 1, fanout);
+    }
+    return first_root;
+}
+
+// Whole system: cascade query, one compose_transforms per changed table
+static void bench_system(void) {
+    ecs_world_t* world = ecs_init();
+    register_transform3d(world);
+    ecs_entity_t system = ecs_lookup(world, "update_transform_system");
+
+    int total;
+    ecs_entity_t first_root = build_scene(world, BENCH_ENTITIES, 2, BENCH_CHILDREN_PER_PARENT, &total);
+
+    ecs_run(world, system, 0.0f, NULL); // Warm up (and compute everything once)
+    double seconds = time_system(world, system, first_root);
+    printf("update_transform_system (%s), all changed: %d entities, %.3f ms/update, %.1f M entities/s\n",
+           transform_kernel_name(get_transform_kernel()), total, seconds * 1000.0 / BENCH_REPEATS,
+           (double)total * BENCH_REPEATS / seconds / 1e6);
+
+    seconds = time_system(world, system, 0);
+    printf("update_transform_system (%s), static: %d entities, %.3f ms/update\n",
+           transform_kernel_name(get_transform_kernel()), total, seconds * 1000.0 / BENCH_REPEATS);
+
+    ecs_fini(world);
+}
+
+// Thread count against entity count and depth, every table changed each update.
+// 1 thread is the serial path (no job pool).
+static void bench_threads(void) {
+    static const struct { int entities, depth, fanout; } scenes[] = {
+        { 100000, 2, 64 },
+        { 1000000, 2, 64 },
+        { 1000000, 4, 16 },
+        { 1000000, 8, 4 },
+    };
+    int cores = SDL_GetNumLogicalCPUCores();
+
+    printf("\n%-10s %6s %7s %8s %12s %8s\n", "entities", "depth", "fanout", "threads", "ms/update", "speedup");
+    for (int i = 0; i < (int)(sizeof(scenes) / sizeof(scenes[0])); i++) {
+        ecs_world_t* world = ecs_init();
+        register_transform3d(world);
+        ecs_entity_t system = ecs_lookup(world, "update_transform_system");
+        int total;
+        ecs_entity_t first_root = build_scene(world, scenes[i].entities, scenes[i].depth, scenes[i].fanout, &total);
+        ecs_run(world, system, 0.0f, NULL); // Warm up
+
+        double serial = 0.0;
+        for (int threads = 1; threads <= cores; threads *= 2) {
+            if (threads > 1 && !init_job_pool(threads - 1)) break;
+            double ms = time_system(world, system, first_root) * 1000.0 / BENCH_REPEATS;
+            cleanup_job_pool();
+            if (threads == 1) serial = ms;
+            printf("%-10d %6d %7d %8d %12.3f %7.2fx\n", total, scenes[i].depth, scenes[i].fanout, threads, ms, serial / ms);
+        }
+        ecs_fini(world);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+
+    bench_kernels();
+    bench_system();
+    bench_threads();
+    return 0;
+}
@@ -0,0 +1,94 @@
+// mesh_format.h
+#pragma once
+
+// On-disk mesh container written by tools/mesh_cooker and read by module_mesh.
+// Everything is little-endian and laid out so that the vertex and index blocks can be
+// handed to glBufferData straight from a memory-mapped file:
+//
+//   MeshFileHeader
+//   MeshAttribute[attribute_count]   at attribute_offset
+//   MeshSubmesh[submesh_count]       at submesh_offset
+//   vertices                         at vertex_offset, vertex_count * vertex_stride bytes
+//   indices                          at index_offset, index_count * index_size bytes
+//
+// Block offsets are from the start of the file and 16 byte aligned.
+
+#include <stdint.h>
+
+#define MESH_MAGIC   0x4853454Du // "MESH"
+#define MESH_VERSION 2
+#define MESH_ALIGN   16
+
+// Attribute semantics double as shader locations (matches the cube shaders)
+enum {
+    MESH_ATTRIB_POSITION = 0,
+    MESH_ATTRIB_TEXCOORD = 1,
+    MESH_ATTRIB_NORMAL   = 2,
+    MESH_ATTRIB_COLOR    = 3,
+    MESH_ATTRIB_COUNT
+};
+
+// Vertex component formats. Every format is a multiple of 4 bytes so attributes stay aligned.
+enum {
+    MESH_FORMAT_FLOAT2,
+    MESH_FORMAT_FLOAT3,
+    MESH_FORMAT_FLOAT4,
+    MESH_FORMAT_HALF2,       // GL_HALF_FLOAT x2
+    MESH_FORMAT_HALF4,       // GL_HALF_FLOAT x4 (positions, w = 1)
+    MESH_FORMAT_SNORM16x4,   // GL_SHORT x4 normalized (positions, dequantized with position_scale/offset)
+    MESH_FORMAT_UNORM16x2,   // GL_UNSIGNED_SHORT x2 normalized (texcoords in [0, 1])
+    MESH_FORMAT_SNORM10x3,   // GL_INT_2_10_10_10_REV normalized (unit normals, w unused)
+    MESH_FORMAT_COUNT
+};
+
+typedef struct {
+    uint32_t magic;            // MESH_MAGIC
+    uint32_t version;          // MESH_VERSION
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t vertex_stride;    // Bytes per vertex
+    uint32_t index_size;       // 2 or 4 bytes
+    uint32_t attribute_count;
+    uint32_t submesh_count;
+    uint32_t attribute_offset;
+    uint32_t submesh_offset;
+    uint32_t vertex_offset;
+    uint32_t index_offset;
+    float bounds_min[3];
+    float bounds_max[3];
+    // Quantized positions: position = offset + scale * stored (stored in [-1, 1]).
+    // scale 1 and offset 0 for float and half positions.
+    float position_scale[3];
+    float position_offset[3];
+} MeshFileHeader;
+
+typedef struct {
+    uint32_t semantic;         // MESH_ATTRIB_*
+    uint32_t format;           // MESH_FORMAT_*
+    uint32_t offset;           // Byte offset inside a vertex
+    uint32_t reserved;
+} MeshAttribute;
+
+typedef struct {
+    uint32_t index_start;      // First index
+    uint32_t index_count;
+    uint32_t material;         // Index of the source material/group, in file order
+    uint32_t reserved;
+    float bounds_min[3];
+    float bounds_max[3];
+} MeshSubmesh;
+
+// Size in bytes of one MESH_FORMAT_* value, 0 if unknown
+static inline uint32_t mesh_format_size(uint32_t format) {
+    switch (format) {
+        case MESH_FORMAT_FLOAT2: return 8;
+        case MESH_FORMAT_FLOAT3: return 12;
+        case MESH_FORMAT_FLOAT4: return 16;
+        case MESH_FORMAT_HALF2: return 4;
+        case MESH_FORMAT_HALF4: return 8;
+        case MESH_FORMAT_SNORM16x4: return 8;
+        case MESH_FORMAT_UNORM16x2: return 4;
+        case MESH_FORMAT_SNORM10x3: return 4;
+        default: return 0;
+    }
+}
@@ -0,0 +1,26 @@
+// module_arena.h
+#pragma once
+
+#include <stddef.h>
+
+// Bump allocator for short-lived data (per-frame vertices and the like).
+// Memory comes from a chain of blocks; nothing is freed one by one, the arena is
+// rewound to a mark or reset as a whole.
+typedef struct FrameArena FrameArena;
+
+// Position in the arena to rewind to
+typedef struct {
+    void* block;
+    size_t used;
+} FrameArenaMark;
+
+// block_size is the size of the first block; later blocks grow to fit larger requests
+int init_frame_arena(size_t block_size, FrameArena** arena);
+// Returns 16 byte aligned memory, NULL if out of memory
+void* frame_arena_alloc(FrameArena* arena, size_t size);
+FrameArenaMark frame_arena_mark(FrameArena* arena);
+// Free everything allocated after the mark (blocks are kept for reuse)
+void frame_arena_rewind(FrameArena* arena, FrameArenaMark mark);
+// Free everything; if more than one block was needed they are merged into one
+void frame_arena_reset(FrameArena* arena);
+void cleanup_frame_arena(FrameArena* arena);
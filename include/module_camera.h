@@ -0,0 +1,57 @@
+// module_camera.h
+#pragma once
+
+#include <stdbool.h>
+#include <glad/gl.h>
+#include <cglm/cglm.h>
+#include "flecs.h"
+
+// Uniform buffer binding point of the camera block, shared by every 3D program
+#define CAMERA_UBO_BINDING 0
+
+// Paste into a 3D vertex shader source after the #version line
+#define CAMERA_UNIFORM_BLOCK \
+    "layout(std140) uniform Camera {\n" \
+    "    mat4 view;\n" \
+    "    mat4 projection;\n" \
+    "    mat4 viewProjection;\n" \
+    "    vec4 cameraPosition;\n" \
+    "};\n"
+
+typedef struct {
+    vec3 position;     // Eye
+    vec3 target;       // Point looked at
+    vec3 up;
+    float fov;         // Vertical field of view in degrees
+    float nearPlane, farPlane;
+    bool isDirty;      // Set after editing; update_camera_system publishes it
+} Camera3D;
+extern ECS_COMPONENT_DECLARE(Camera3D);
+
+// std140 layout of the Camera block
+typedef struct {
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 position;
+} CameraMatrices;
+
+// Viewport size in pixels, set from the main loop (only marks the camera dirty if it changed)
+void set_camera_viewport(int width, int height);
+// Use these camera values (only marks the camera dirty if they changed)
+void set_camera(const Camera3D* camera);
+// Recompute and upload the matrices if the camera or viewport changed, and keep the
+// buffer bound at CAMERA_UBO_BINDING. Call before drawing 3D.
+void update_camera_buffer(void);
+// Matrices of the current camera (call update_camera_buffer first)
+const CameraMatrices* get_camera_matrices(void);
+// Distance of a world position along the view direction, 0 at the near plane and
+// 1 at the far plane (clamped); for sorting draws
+float get_camera_depth(const vec3 position);
+// Point a program's Camera block at CAMERA_UBO_BINDING (GLSL 330 has no binding qualifier)
+void bind_camera_block(GLuint program);
+void cleanup_camera(void);
+
+// Register Camera3D and update_camera_system (EcsPreUpdate)
+void register_camera(ecs_world_t* world);
+void update_camera_system(ecs_iter_t *it);
@@ -3,17 +3,22 @@
 
 #include <glad/gl.h>
 #include <cglm/cglm.h> // Include CGLM
+#include "module_mesh.h"
+#include "module_texture.h"
+
+#define CUBE_MESH_PATH "resources/cube.mesh"
 
 typedef struct {
-    GLuint texture;
-    GLuint vao, vbo;
+    Texture* texture;   // From load_texture_async, bind texture->id
+    Mesh mesh;
 } CubeData;
 
-// Initialize cube (unchanged)
+// Queue the texture (needs init_texture_loader) and load the cube mesh (CUBE_MESH_PATH)
 int init_cube(const char* texture_path, CubeData* cube_data);
+void cleanup_cube(CubeData* cube_data);
 
 // Initialize cube shaders
 int init_cube_shaders_and_buffers(GLuint* cube_program);
 
-// Render cube with CGLM matrices
+// Render cube with CGLM matrices; ww/hh set the camera viewport (see module_camera.h)
 void render_cube(CubeData* cube_data, GLuint program, vec3 rotation, int ww, int hh);
@@ -5,22 +5,85 @@
 // #define MODULE_FONT_H
 
 #include <glad/gl.h>
+#include "module_render_queue.h"
 
 // Opaque pointer to FontData
 typedef struct FontData FontData;
 
 int init_font_shaders_and_buffers(GLuint* program, GLuint* vao, GLuint* vbo);
 
+// Directory for baked atlas caches ("cache" by default, NULL or "" disables)
+void set_font_cache_dir(const char* dir);
+
 // Functions using FontData
 int init_font(const char* font_path, float font_size, float scale, FontData** font_data);
+// Text of any length is drawn, in draws of up to 4096 glyphs
 void render_text(FontData* font_data, GLuint program, GLuint vao, GLuint vbo, const char* text, float x, float y, int ww, int hh, float r, float g, float b, float a);
+
+// Signed distance field font: one atlas at base_size serves every text size.
+// size is the pixel height to draw at, 0 draws at the size the font was loaded at.
+int init_font_sdf(const char* font_path, float base_size, FontData** font_data);
+void render_text_sized(FontData* font_data, GLuint program, GLuint vao, GLuint vbo, const char* text, float x, float y, float size, int ww, int hh, float r, float g, float b, float a);
 void cleanup_font(FontData* font_data);
 
+// Text measurement and layout from cached glyph metrics. No GL calls, glyphs are not
+// rasterized, so these are safe to run for UI layout before anything is drawn.
+typedef struct {
+    float x0, y0, x1, y1;   // Ink box relative to the pen start on the baseline (y down)
+} TextBounds;
+
+typedef struct {
+    int start, length;      // Byte range of the line in TextLayout.text, trailing spaces excluded
+    float width;            // Advance width in pixels
+} TextLine;
+
+typedef struct {
+    const char* text;       // Copy of the laid out string
+    const TextLine* lines;
+    int line_count;
+    float width, height;    // Size of the wrapped block in pixels
+    float line_height;      // Distance between baselines
+    float max_width;        // Width the lines were fitted to (0 = no wrapping)
+} TextLayout;
+
+// Advance width of a single line in pixels; bounds (optional) receives the ink box
+float measure_text(FontData* font_data, const char* text, float size, TextBounds* bounds);
+float get_font_line_height(FontData* font_data, float size);
+// Wrap a paragraph at spaces to max_width (0 = break only at '\n'). Cached per string,
+// a new max_width only refits lines. Valid until the next layout_text call on the font.
+const TextLayout* layout_text(FontData* font_data, const char* text, float size, float max_width);
+
 // Alternative functions (no FontData, for internal management)
 int init_font_alt(const char* font_path, float font_size, float scale);
 void render_text_alt(GLuint program, GLuint vao, GLuint vbo, const char* text, float x, float y, int ww, int hh, float r, float g, float b, float a);
 void cleanup_font_alt(void);
 
+// Opaque pointer to TextBatch
+typedef struct TextBatch TextBatch;
+
+// Batched text: queue any number of strings per frame, then draw them with one upload
+// and one draw call per font atlas.
+int init_text_batch(TextBatch** batch);
+void begin_text_batch(TextBatch* batch, int ww, int hh);
+void queue_text(TextBatch* batch, FontData* font_data, const char* text, float x, float y, float r, float g, float b, float a);
+void queue_text_sized(TextBatch* batch, FontData* font_data, const char* text, float x, float y, float size, float r, float g, float b, float a);
+// Queue every line of a layout_text result; y is the baseline of the first line
+void queue_text_layout(TextBatch* batch, FontData* font_data, const TextLayout* layout, float size, float x, float y, float r, float g, float b, float a);
+void flush_text_batch(TextBatch* batch);
+// Flush the batch from the render queue instead (transparent, RENDER_LAYER_UI)
+void submit_text_batch(RenderQueue* queue, TextBatch* batch);
+// Before cleanup_font of the fonts it queued text for
+void cleanup_text_batch(TextBatch* batch);
+
+typedef struct TextObject TextObject;
+
+// Retained text: laid out and uploaded once, rebuilt only when the string, size, color
+// or font changes (or the atlas evicted glyphs). Moving it only changes a uniform.
+int create_text_object(FontData* font_data, const char* text, float size, float r, float g, float b, float a, TextObject** text_object);
+int update_text_object(TextObject* text_object, FontData* font_data, const char* text, float size, float r, float g, float b, float a);
+void draw_text_object(TextBatch* batch, TextObject* text_object, float x, float y);
+void cleanup_text_object(TextObject* text_object);
+
 // #endif // MODULE_FONT_H
 
 
@@ -0,0 +1,48 @@
+// module_glstate.h
+#pragma once
+
+#include <glad/gl.h>
+
+// Shadowed GL state: each call is skipped when it would set what is already set.
+// Anything that changes this state behind our back (ImGui's backend, raw gl calls)
+// must be followed by glstate_invalidate().
+
+#define GLSTATE_TEXTURE_UNITS 16
+
+typedef enum {
+    GLSTATE_PROGRAM,
+    GLSTATE_VERTEX_ARRAY,
+    GLSTATE_ACTIVE_TEXTURE,
+    GLSTATE_TEXTURE,
+    GLSTATE_CAPABILITY,
+    GLSTATE_BLEND_FUNC,
+    GLSTATE_DEPTH_MASK,
+    GLSTATE_CALL_COUNT
+} GLStateCall;
+
+typedef struct {
+    unsigned int issued[GLSTATE_CALL_COUNT];  // Reached the driver
+    unsigned int elided[GLSTATE_CALL_COUNT];  // Matched the shadow and were skipped
+    unsigned int total_issued, total_elided;
+} GLStateStats;
+
+void glstate_use_program(GLuint program);
+void glstate_bind_vertex_array(GLuint vao);
+void glstate_active_texture(GLenum unit);                 // GL_TEXTURE0 + n
+void glstate_bind_texture(GLenum target, GLuint texture); // On the active unit
+void glstate_enable(GLenum cap);
+void glstate_disable(GLenum cap);
+void glstate_blend_func(GLenum src, GLenum dst);
+void glstate_depth_mask(GLboolean write);
+
+// Delete and drop from the shadow, so a recycled name is bound for real
+void glstate_delete_texture(GLuint* texture);
+void glstate_delete_vertex_array(GLuint* vao);
+
+// Forget everything; the next call of each kind reaches the driver
+void glstate_invalidate(void);
+
+// Start counting a new frame; glstate_get_stats then reports the finished one
+void glstate_begin_frame(void);
+const GLStateStats* glstate_get_stats(void);
+const char* glstate_call_name(GLStateCall call);
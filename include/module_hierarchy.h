@@ -0,0 +1,49 @@
+// module_hierarchy.h
+#pragma once
+
+#include <stdbool.h>
+#include "flecs.h"
+
+// Flat, depth-first copy of the transform hierarchy (entities with WorldMatrix,
+// linked by ChildOf). Parents come before their children and every subtree is one
+// contiguous run, so walks, picking and the outliner loop over one array instead of
+// calling ecs_get_parent / ecs_children per entity.
+//
+// Observers on ChildOf and WorldMatrix keep it current: a spawned entity is inserted
+// at the end of its parent's run, a reparented subtree is moved as one block and a
+// removed entity is cut out. Changes routed through entities without WorldMatrix, and
+// changes that would shift too much of the array (bulk spawns and deletes), fall back
+// to one full rebuild in update_hierarchy_cache.
+
+typedef struct {
+    ecs_entity_t entity;
+    int parent;     // Index of the nearest transform ancestor, -1 for roots
+    int depth;      // 0 for roots
+    int subtree;    // Nodes in the subtree, this one included: the next sibling is at index + subtree
+} HierarchyNode;
+
+typedef struct {
+    ecs_entity_t entity;    // 0 = empty
+    int index;
+} HierarchySlot;
+
+typedef struct {
+    ecs_world_t* world;
+    ecs_query_t* roots;     // WorldMatrix without a WorldMatrix ancestor (full rebuilds)
+    HierarchyNode* nodes;   // Depth-first order
+    int count;
+    int capacity;
+    HierarchySlot* map;     // Open addressing entity -> node index
+    int map_capacity;       // Power of two
+    bool stale;             // Needs a full rebuild
+    int splices;            // In-place changes since the last update
+    unsigned int version;   // Bumped on every change: indices kept from an older version are invalid
+} HierarchyCache;
+
+// Needs register_transform3d first. The cache is freed by ecs_fini.
+HierarchyCache* create_hierarchy_cache(ecs_world_t* world);
+// Rebuild if a change was not applied in place; returns true if it did.
+// Call it outside systems (for example once per frame before the UI).
+bool update_hierarchy_cache(HierarchyCache* cache);
+// Index of the entity's node, -1 if it is not in the cache
+int find_hierarchy_node(const HierarchyCache* cache, ecs_entity_t entity);
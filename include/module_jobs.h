@@ -0,0 +1,19 @@
+// module_jobs.h
+#pragma once
+
+// Fork-join worker pool for data-parallel loops. run_jobs hands out indices
+// [0, count) to the workers and the calling thread and returns once every job is
+// done, so back-to-back calls are separated by a barrier.
+
+typedef void (*JobFunction)(void* ctx, int index);
+
+// Start the workers. worker_count 0 uses one thread per logical core but one
+// (the thread calling run_jobs works too).
+int init_job_pool(int worker_count);
+void cleanup_job_pool(void);
+// Worker threads, 0 when the pool is not running
+int get_job_worker_count(void);
+
+// fn(ctx, i) for every i in [0, count), in any order and on any thread.
+// Runs inline when the pool is not running. Not reentrant: call it from one thread.
+void run_jobs(int count, JobFunction fn, void* ctx);
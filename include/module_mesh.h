@@ -0,0 +1,43 @@
+// module_mesh.h
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <glad/gl.h>
+#include <cglm/cglm.h>
+#include "mesh_format.h"
+
+// Mesh loaded from a .mesh file (see mesh_format.h and tools/mesh_cooker)
+typedef struct {
+    GLuint vao, vbo, ebo;
+    GLenum index_type;          // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    int index_size;             // 2 or 4
+    int vertex_count, index_count;
+    int vertex_stride;
+    MeshAttribute attributes[MESH_ATTRIB_COUNT];
+    int attribute_count;
+    MeshSubmesh* submeshes;
+    int submesh_count;
+    vec3 bounds_min, bounds_max;
+    bool quantized;             // Positions are SNORM16, see get_mesh_model_matrix
+    mat4 dequantize;            // Stored position to mesh space
+} Mesh;
+
+// Attribute mask for setup_mesh_vertex_array
+#define MESH_ATTRIB_BIT(semantic) (1u << (semantic))
+#define MESH_ATTRIB_ALL 0xFFFFFFFFu
+
+// Map the file, check it and upload the vertex and index blocks as they are
+int load_mesh(const char* path, Mesh* mesh);
+// Same from bytes already in memory (a .mesh file image)
+int create_mesh_from_memory(const void* data, size_t size, Mesh* mesh);
+// Point a VAO at the mesh buffers, enabling only the attributes in mask (their
+// semantic is the location). The mesh's own VAO is set up with MESH_ATTRIB_ALL.
+void setup_mesh_vertex_array(const Mesh* mesh, GLuint vao, uint32_t mask);
+// Draw with the mesh VAO (all submeshes, or one)
+void draw_mesh(const Mesh* mesh);
+void draw_submesh(const Mesh* mesh, int submesh);
+void cleanup_mesh(Mesh* mesh);
+// dest = model * dequantize, the matrix to draw a quantized mesh with (a copy otherwise)
+void get_mesh_model_matrix(const Mesh* mesh, mat4 model, mat4 dest);
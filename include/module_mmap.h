@@ -0,0 +1,21 @@
+// module_mmap.h
+#pragma once
+
+#include <stddef.h>
+
+// Read-only memory-mapped file
+typedef struct {
+    const unsigned char* data; // Mapped bytes (NULL for an empty file)
+    size_t size;               // File size in bytes
+#ifdef _WIN32
+    void* file_handle;         // HANDLE from CreateFileA
+    void* mapping_handle;      // HANDLE from CreateFileMappingA
+#endif
+} MappedFile;
+
+// Map a whole file read-only. Returns 0 if the file does not exist or cannot be mapped.
+int map_file_open(const char* path, MappedFile* file);
+void map_file_close(MappedFile* file);
+
+// Create a directory if it does not exist yet (one level). Returns 1 if it exists afterwards.
+int make_directory(const char* path);
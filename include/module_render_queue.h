@@ -0,0 +1,45 @@
+// module_render_queue.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <glad/gl.h>
+
+// Draw items are collected during the frame and drawn in sort key order by
+// submit_render_queue, once, after ecs_progress.
+//
+// Key, high bits first:
+//   opaque:      layer:4 | 0 | program:10 | texture:10 | vao:10 | depth:24      (state, then front-to-back)
+//   transparent: layer:4 | 1 | far-depth:24 | program:10 | texture:10 | vao:10  (back-to-front, then state)
+// Ids are truncated to 10 bits; that only affects grouping, items keep the full ids.
+
+#define RENDER_LAYER_WORLD 0
+#define RENDER_LAYER_UI    15
+
+typedef struct RenderQueue RenderQueue;
+typedef struct RenderItem RenderItem;
+
+// Called with the item's program, VAO and texture (unit 0) bound
+typedef void (*RenderDrawFn)(const RenderItem* item);
+
+struct RenderItem {
+    GLuint program;     // 0: leave the bound program alone
+    GLuint vao;         // 0: leave the bound VAO alone
+    GLuint texture;     // 0: leave the bound texture alone
+    bool transparent;   // Blend on, depth writes off
+    RenderDrawFn draw;
+    void* data;         // Usually from render_queue_alloc
+};
+
+uint64_t make_render_key(int layer, bool transparent, GLuint program, GLuint texture, GLuint vao, float depth);
+
+int init_render_queue(RenderQueue** queue);
+// Add an item; returns it zeroed for the caller to fill, NULL if out of memory
+RenderItem* push_render_item(RenderQueue* queue, uint64_t key);
+// Per-item data that lives until the queue is submitted
+void* render_queue_alloc(RenderQueue* queue, size_t size);
+// Sort, draw and empty the queue
+void submit_render_queue(RenderQueue* queue);
+int get_render_queue_count(const RenderQueue* queue);
+void cleanup_render_queue(RenderQueue* queue);
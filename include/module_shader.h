@@ -0,0 +1,51 @@
+// module_shader.h
+#pragma once
+
+#include <glad/gl.h>
+
+// Active uniform found by glGetActiveUniform
+typedef struct {
+    char name[64];
+    GLint location;
+    GLenum type;                  // GL_FLOAT_MAT4, GL_SAMPLER_2D, ...
+    GLint size;                   // Array length (1 for plain uniforms)
+} ShaderUniform;
+
+// Linked program with its uniforms reflected once. Look names up with
+// find_shader_uniform at init and keep the index; the setters take that index,
+// so nothing is looked up by string while drawing.
+typedef struct {
+    GLuint id;
+    unsigned int serial;          // Unique per reflection; tells callers caching indices that an id was reused
+    ShaderUniform* uniforms;
+    int uniform_count;
+    int* uniform_map;             // Open addressing name hash -> uniform index + 1 (0 = empty)
+    int map_capacity;             // Power of two
+} ShaderProgram;
+
+// Keep linked programs as driver binaries in dir (GL_ARB_get_program_binary) so later
+// runs skip GLSL compilation. Call after gladLoadGL; load is the same loader
+// (SDL_GL_GetProcAddress). Returns 1 if the driver supports program binaries.
+int init_shader_cache(const char* dir, GLADloadfunc load);
+
+// Compile and link a vertex + fragment shader, or load it from the shader cache.
+// Errors are printed with label. Returns the program id, 0 on failure.
+GLuint compile_shader_program(const char* vs_src, const char* fs_src, const char* label);
+
+// Shader for a program id, reflected the first time the id is seen (no string lookups)
+ShaderProgram* get_shader_program(GLuint program);
+// Compile, link and reflect in one step. Returns NULL on failure.
+ShaderProgram* create_shader_program(const char* vs_src, const char* fs_src, const char* label);
+// Forget the reflection and delete the GL program
+void release_shader_program(GLuint program);
+
+// Index of an active uniform, -1 if the program has none by that name (setters ignore -1)
+int find_shader_uniform(const ShaderProgram* shader, const char* name);
+
+// Typed setters; the program must be bound with glUseProgram
+void set_uniform_int(const ShaderProgram* shader, int uniform, int value);
+void set_uniform_float(const ShaderProgram* shader, int uniform, float value);
+void set_uniform_vec2(const ShaderProgram* shader, int uniform, float x, float y);
+void set_uniform_vec3(const ShaderProgram* shader, int uniform, float x, float y, float z);
+void set_uniform_vec4(const ShaderProgram* shader, int uniform, float x, float y, float z, float w);
+void set_uniform_mat4(const ShaderProgram* shader, int uniform, const float* matrix);
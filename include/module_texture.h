@@ -0,0 +1,44 @@
+// module_texture.h
+#pragma once
+
+#include <stddef.h>
+#include <glad/gl.h>
+
+// Asynchronous texture loading. Worker threads decode the files with stb_image.
+// update_texture_loader then streams the pixels to GL through pixel buffer objects,
+// a few rows at a time within a per-frame byte budget. Until a texture is complete,
+// its id is a shared placeholder, so it can be bound right away.
+
+#define TEXTURE_UPLOAD_BUDGET (4 * 1024 * 1024) // Default bytes per frame for update_texture_loader
+
+typedef enum {
+    TEXTURE_PENDING,    // id is the placeholder
+    TEXTURE_READY,      // id is the loaded texture
+    TEXTURE_FAILED      // id stays the placeholder
+} TextureStatus;
+
+typedef struct TextureJob TextureJob;
+
+typedef struct {
+    GLuint id;              // Read it when binding: it changes once the load finishes
+    int width, height;      // 0 until ready
+    TextureStatus status;
+    GLint filter;           // GL_NEAREST or GL_LINEAR, for both min and mag
+    TextureJob* job;        // Loader internal, NULL once uploaded
+} Texture;
+
+// Start the workers and create the placeholder and PBOs. worker_count 0 uses one
+// thread per logical core but one (that one is the render thread).
+int init_texture_loader(int worker_count);
+void cleanup_texture_loader(void);
+
+// Queue a file and return its texture right away (status TEXTURE_PENDING, placeholder id).
+// Returns NULL if the loader is not running or out of memory.
+Texture* load_texture_async(const char* path, GLint filter);
+// Delete the texture; a load still in flight is dropped when it finishes decoding
+void release_texture(Texture* texture);
+
+// Render thread, once per frame: upload up to budget bytes of decoded pixels
+void update_texture_loader(size_t budget);
+// Textures queued or uploading (for loading screens)
+int get_texture_loader_pending(void);
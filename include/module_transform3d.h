@@ -0,0 +1,53 @@
+// module_transform3d.h
+#pragma once
+
+#include <stdbool.h>
+#include <glad/gl.h>
+#include <cglm/cglm.h>
+#include "flecs.h"
+#include "module_shader.h"
+#include "module_render_queue.h"
+#include "module_mesh.h"
+#include "module_transform_kernel.h"
+
+// Transforms are split so update_transform_system streams only what it needs:
+// Position3, Rotation and Scale3 in, WorldMatrix (3x4 affine) out. The types live in
+// module_transform_kernel.h with the batch kernels.
+extern ECS_COMPONENT_DECLARE(Position3);
+extern ECS_COMPONENT_DECLARE(Rotation);
+extern ECS_COMPONENT_DECLARE(Scale3);
+extern ECS_COMPONENT_DECLARE(WorldMatrix);
+
+// Give an entity all four transform components (rotation is a quaternion x, y, z, w)
+void set_transform3d(ecs_world_t* world, ecs_entity_t entity, vec3 position, versor rotation, vec3 scale);
+// Full 4x4 column-major matrix for GL uploads and cglm
+void world_matrix_to_mat4(const WorldMatrix* world, mat4 dest);
+
+typedef struct {
+    Mesh mesh;            // Cube mesh (its VAO reads position, texcoord and normal)
+    ShaderProgram* shader; // Shader program for the cube
+    int modelUniform;     // View and projection come from the camera block (module_camera.h)
+    RenderQueue* queue;   // When set, render_3d_cube_system pushes draw items here instead of drawing
+
+    // Instanced path: every world matrix of the frame in one buffer, one draw call
+    bool instanced;               // Use the instanced path in render_3d_cube_system
+    ShaderProgram* instanceShader;
+    GLuint instanceVao;           // Cube mesh plus the per-instance mat4 at locations 1..4
+    GLuint instanceVbo;
+    GLsizeiptr instanceVboSize;   // Bytes
+    mat4* instanceMatrices;       // CPU staging for the frame's matrices
+    int instanceCapacity;
+} CubeContext;
+
+bool init_cube_mesh(CubeContext* cube);
+void cleanup_cube_mesh(CubeContext* cube);
+
+// Register the transform components and systems: update_transform_system in EcsPreUpdate
+// (parents before children, via a cascade term on ChildOf; only tables whose transforms
+// or parent changed are recomputed, so call ecs_modified after ecs_get_mut; each depth
+// runs on the job pool when init_job_pool was called, see module_jobs.h) and
+// render_3d_cube_system in EcsOnUpdate. The systems read the CubeContext from ecs_get_ctx.
+void register_transform3d(ecs_world_t* world);
+
+void update_transform_system(ecs_iter_t *it);
+void render_3d_cube_system(ecs_iter_t *it);
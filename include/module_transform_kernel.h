@@ -0,0 +1,31 @@
+// module_transform_kernel.h
+#pragma once
+
+// Batch TRS composition for the split transform components (module_transform3d.h).
+// Plain C structs so the kernels and the benchmark do not need flecs.
+
+typedef struct { float x, y, z; } Position3;
+typedef struct { float x, y, z, w; } Rotation;      // Quaternion, need not be unit length
+typedef struct { float x, y, z; } Scale3;
+
+// Affine 3x4, row-major: world point = rows * (x, y, z, 1). The fourth row of the
+// full matrix is always (0, 0, 0, 1).
+typedef struct { float rows[3][4]; } WorldMatrix;
+
+typedef enum {
+    TRANSFORM_KERNEL_SCALAR,
+    TRANSFORM_KERNEL_SSE,       // 4 entities per step (SSE2)
+    TRANSFORM_KERNEL_AVX2,      // 8 entities per step (AVX2 + FMA)
+    TRANSFORM_KERNEL_COUNT
+} TransformKernel;
+
+// out[i] = parent * T(position[i]) * R(rotation[i]) * S(scale[i]); parent NULL for roots.
+// Uses the kernel picked by select_transform_kernel (the widest the CPU runs by default).
+void compose_transforms(const Position3* position, const Rotation* rotation, const Scale3* scale,
+                        const WorldMatrix* parent, WorldMatrix* out, int count);
+
+// Returns 0 if this build or CPU cannot run the kernel (the current one is kept)
+int select_transform_kernel(TransformKernel kernel);
+int transform_kernel_supported(TransformKernel kernel);
+TransformKernel get_transform_kernel(void);
+const char* transform_kernel_name(TransformKernel kernel);
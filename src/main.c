@@ -11,6 +11,10 @@
 #include "module_cube.h" // Added for cube functionality
 #include "module_lua.h" // Added for Lua module
 #include "module_flecs.h" // Added for Flecs module
+#include "module_shader.h"
+#include "module_camera.h"
+#include "module_glstate.h"
+#include "module_texture.h"
 
 #define igGetIO igGetIO_Nil
 
@@ -53,6 +57,17 @@ int main(int argc, char* argv[]) {
     }
     printf("OpenGL loaded: version %s\n", glGetString(GL_VERSION));
 
+    // Linked shader programs are kept in cache/ so later runs skip GLSL compilation
+    init_shader_cache("cache", (GLADloadfunc)SDL_GL_GetProcAddress);
+
+    // Textures decode on worker threads and upload a slice per frame
+    if (!init_texture_loader(0)) {
+        SDL_GL_DestroyContext(gl_context);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 1;
+    }
+
     // Setup Dear ImGui context
     igCreateContext(NULL);
     ImGuiIO* io = igGetIO();
@@ -120,9 +135,7 @@ int main(int argc, char* argv[]) {
     GLuint cube_program;
     if (!init_cube_shaders_and_buffers(&cube_program)) {
         printf("Error: Failed to initialize cube shaders\n");
-        glDeleteTextures(1, &cube_data.texture);
-        glDeleteVertexArrays(1, &cube_data.vao);
-        glDeleteBuffers(1, &cube_data.vbo);
+        cleanup_cube(&cube_data);
         cleanup_font(font_data);
         SDL_GL_DestroyContext(gl_context);
         SDL_DestroyWindow(window);
@@ -131,9 +144,9 @@ int main(int argc, char* argv[]) {
     }
 
     // Enable depth testing for cube rendering
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glstate_enable(GL_DEPTH_TEST);
+    glstate_enable(GL_BLEND);
+    glstate_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Our state
     bool show_demo_window = true;
@@ -171,6 +184,9 @@ int main(int argc, char* argv[]) {
         // Call Flecs update (progresses phases and runs systems)
         module_update_flecs(&flecs_data, dt);
 
+        glstate_begin_frame(); // GL state counters are per frame
+        update_texture_loader(TEXTURE_UPLOAD_BUDGET);
+
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL3_NewFrame();
@@ -196,6 +212,9 @@ int main(int argc, char* argv[]) {
             igSameLine(0.0f, -1.0f);
             igText("counter = %d", counter);
             igText("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io->Framerate, io->Framerate);
+            const GLStateStats* gl_stats = glstate_get_stats();
+            igText("GL state calls: %u issued, %u elided", gl_stats->total_issued, gl_stats->total_elided);
+            igText("Textures loading: %d", get_texture_loader_pending());
             igEnd();
         }
 
@@ -231,6 +250,7 @@ int main(int argc, char* argv[]) {
 
         // Render ImGui
         ImGui_ImplOpenGL3_RenderDrawData(igGetDrawData());
+        glstate_invalidate(); // ImGui's backend binds GL state directly
         SDL_GL_SwapWindow(window);
     }
 
@@ -241,10 +261,10 @@ int main(int argc, char* argv[]) {
 
 
     // Clean up cube resources
-    glDeleteTextures(1, &cube_data.texture);
-    glDeleteVertexArrays(1, &cube_data.vao);
-    glDeleteBuffers(1, &cube_data.vbo);
-    glDeleteProgram(cube_program);
+    cleanup_cube(&cube_data);
+    release_shader_program(cube_program);
+    cleanup_camera();
+    cleanup_texture_loader(); // After every texture is released
 
     cleanup_font(font_data);
     
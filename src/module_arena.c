@@ -0,0 +1,128 @@
+// module_arena.c
+#include "module_arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ARENA_ALIGN 16
+
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;                  // Usable bytes after the header
+    size_t used;
+} ArenaBlock;
+
+struct FrameArena {
+    ArenaBlock* first;
+    ArenaBlock* current;          // Block allocations come from
+    size_t block_size;
+};
+
+// Header rounded up so block data stays aligned
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+static ArenaBlock* create_arena_block(size_t size) {
+    ArenaBlock* block = (ArenaBlock*)malloc(ARENA_HEADER + size);
+    if (!block) {
+        printf("Error: Failed to allocate arena block of %zu bytes\n", size);
+        return NULL;
+    }
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+static unsigned char* block_data(ArenaBlock* block) {
+    return (unsigned char*)block + ARENA_HEADER;
+}
+
+int init_frame_arena(size_t block_size, FrameArena** arena) {
+    *arena = (FrameArena*)calloc(1, sizeof(FrameArena));
+    if (!*arena) {
+        printf("Error: Failed to allocate FrameArena\n");
+        return 0;
+    }
+    (*arena)->block_size = block_size ? block_size : 64 * 1024;
+    (*arena)->first = create_arena_block((*arena)->block_size);
+    if (!(*arena)->first) {
+        free(*arena);
+        *arena = NULL;
+        return 0;
+    }
+    (*arena)->current = (*arena)->first;
+    return 1;
+}
+
+void* frame_arena_alloc(FrameArena* arena, size_t size) {
+    if (!arena || !arena->current) return NULL;
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    ArenaBlock* block = arena->current;
+    if (block->used + size > block->size) {
+        ArenaBlock* next = block->next;
+        if (next && next->size >= size) {
+            // Reuse a block left over from a rewind
+            next->used = 0;
+            block = next;
+        } else {
+            size_t new_size = arena->block_size;
+            while (new_size < size) new_size *= 2;
+            ArenaBlock* created = create_arena_block(new_size);
+            if (!created) return NULL;
+            created->next = next; // A spare block that is too small stays in the chain
+            block->next = created;
+            block = created;
+        }
+    }
+    arena->current = block;
+
+    void* ptr = block_data(block) + block->used;
+    block->used += size;
+    return ptr;
+}
+
+FrameArenaMark frame_arena_mark(FrameArena* arena) {
+    FrameArenaMark mark = { arena->current, arena->current->used };
+    return mark;
+}
+
+void frame_arena_rewind(FrameArena* arena, FrameArenaMark mark) {
+    ArenaBlock* block = (ArenaBlock*)mark.block;
+    block->used = mark.used;
+    arena->current = block;
+}
+
+void frame_arena_reset(FrameArena* arena) {
+    if (!arena) return;
+    if (arena->first->next) {
+        // Last frame needed more than one block: replace the chain with one block that fits it all
+        size_t total = 0;
+        ArenaBlock* block = arena->first;
+        while (block) {
+            ArenaBlock* next = block->next;
+            total += block->size;
+            free(block);
+            block = next;
+        }
+        arena->block_size = total;
+        arena->first = create_arena_block(total);
+        if (!arena->first) {
+            // Fall back to the original size so the arena stays usable
+            arena->block_size = 64 * 1024;
+            arena->first = create_arena_block(arena->block_size);
+        }
+    }
+    if (arena->first) arena->first->used = 0;
+    arena->current = arena->first;
+}
+
+void cleanup_frame_arena(FrameArena* arena) {
+    if (!arena) return;
+    ArenaBlock* block = arena->first;
+    while (block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
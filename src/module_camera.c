@@ -0,0 +1,103 @@
+// module_camera.c
+#include <stdio.h>
+#include <string.h>
+
+#include "module_camera.h"
+
+ECS_COMPONENT_DECLARE(Camera3D);
+
+static struct {
+    GLuint ubo;
+    Camera3D camera;              // Values the matrices were built from
+    int width, height;
+    int dirty;
+    CameraMatrices matrices;
+} camera_state = {
+    .camera = {
+        .position = {0.0f, 0.0f, 3.0f},
+        .target = {0.0f, 0.0f, 0.0f},
+        .up = {0.0f, 1.0f, 0.0f},
+        .fov = 45.0f,
+        .nearPlane = 0.1f,
+        .farPlane = 100.0f
+    },
+    .width = 1,
+    .height = 1,
+    .dirty = 1
+};
+
+void set_camera_viewport(int width, int height) {
+    if (width <= 0 || height <= 0) return; // Minimized
+    if (width == camera_state.width && height == camera_state.height) return;
+    camera_state.width = width;
+    camera_state.height = height;
+    camera_state.dirty = 1;
+}
+
+void set_camera(const Camera3D* camera) {
+    Camera3D values = *camera;
+    values.isDirty = false; // Not part of the camera values
+    if (memcmp(&values, &camera_state.camera, sizeof(values)) == 0) return;
+    camera_state.camera = values;
+    camera_state.dirty = 1;
+}
+
+void update_camera_buffer(void) {
+    if (!camera_state.ubo) {
+        glGenBuffers(1, &camera_state.ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, camera_state.ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraMatrices), NULL, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UBO_BINDING, camera_state.ubo);
+        camera_state.dirty = 1;
+    }
+    if (!camera_state.dirty) return;
+
+    Camera3D* camera = &camera_state.camera;
+    CameraMatrices* matrices = &camera_state.matrices;
+    glm_lookat(camera->position, camera->target, camera->up, matrices->view);
+    glm_perspective(glm_rad(camera->fov), (float)camera_state.width / camera_state.height, camera->nearPlane, camera->farPlane, matrices->projection);
+    glm_mat4_mul(matrices->projection, matrices->view, matrices->viewProjection);
+    glm_vec4(camera->position, 1.0f, matrices->position);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, camera_state.ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraMatrices), matrices);
+    camera_state.dirty = 0;
+}
+
+const CameraMatrices* get_camera_matrices(void) {
+    return &camera_state.matrices;
+}
+
+float get_camera_depth(const vec3 position) {
+    const Camera3D* camera = &camera_state.camera;
+    mat4* view = &camera_state.matrices.view;
+    // View space z of the position (the camera looks down -z)
+    float z = -((*view)[0][2] * position[0] + (*view)[1][2] * position[1] + (*view)[2][2] * position[2] + (*view)[3][2]);
+    float depth = (z - camera->nearPlane) / (camera->farPlane - camera->nearPlane);
+    return depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+}
+
+void bind_camera_block(GLuint program) {
+    GLuint block = glGetUniformBlockIndex(program, "Camera");
+    if (block != GL_INVALID_INDEX) glUniformBlockBinding(program, block, CAMERA_UBO_BINDING);
+}
+
+void cleanup_camera(void) {
+    if (camera_state.ubo) glDeleteBuffers(1, &camera_state.ubo);
+    camera_state.ubo = 0;
+}
+
+// Publish edited cameras; the last dirty one wins
+void update_camera_system(ecs_iter_t *it) {
+    Camera3D *cameras = ecs_field(it, Camera3D, 0);
+    for (int i = 0; i < it->count; i++) {
+        if (!cameras[i].isDirty) continue;
+        set_camera(&cameras[i]);
+        cameras[i].isDirty = false;
+    }
+}
+
+void register_camera(ecs_world_t* world) {
+    ECS_COMPONENT_DEFINE(world, Camera3D);
+    ECS_SYSTEM(world, update_camera_system, EcsPreUpdate, Camera3D);
+}
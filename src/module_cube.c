@@ -1,9 +1,9 @@
 // module_cube.c
 
 #include "module_cube.h"
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include "module_shader.h"
+#include "module_glstate.h"
+#include "module_camera.h"
 
 // Initialize cube shaders
 int init_cube_shaders_and_buffers(GLuint* cube_program) {
@@ -15,11 +15,10 @@ int init_cube_shaders_and_buffers(GLuint* cube_program) {
         "out vec2 TexCoord;\n"
         "out vec3 Normal;\n"
         "out vec3 FragPos;\n"
+        CAMERA_UNIFORM_BLOCK
         "uniform mat4 model;\n"
-        "uniform mat4 view;\n"
-        "uniform mat4 projection;\n"
         "void main() {\n"
-        "    gl_Position = projection * view * model * vec4(position, 1.0);\n"
+        "    gl_Position = viewProjection * model * vec4(position, 1.0);\n"
         "    TexCoord = texCoord;\n"
         "    Normal = mat3(transpose(inverse(model))) * normal;\n"
         "    FragPos = vec3(model * vec4(position, 1.0));\n"
@@ -43,140 +42,69 @@ int init_cube_shaders_and_buffers(GLuint* cube_program) {
         "    FragColor = vec4((ambient + diffuse) * texColor.rgb, texColor.a);\n"
         "}\n";
 
-    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vs, 1, &cube_vs_src, NULL);
-    glCompileShader(vs);
-    GLint success;
-    glGetShaderiv(vs, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetShaderInfoLog(vs, 512, NULL, info_log);
-        printf("Cube vertex shader compilation failed: %s\n", info_log);
-        return 0;
-    }
-    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fs, 1, &cube_fs_src, NULL);
-    glCompileShader(fs);
-    glGetShaderiv(fs, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetShaderInfoLog(fs, 512, NULL, info_log);
-        printf("Cube fragment shader compilation failed: %s\n", info_log);
-        glDeleteShader(vs);
-        return 0;
-    }
-    *cube_program = glCreateProgram();
-    glAttachShader(*cube_program, vs);
-    glAttachShader(*cube_program, fs);
-    glLinkProgram(*cube_program);
-    glGetProgramiv(*cube_program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetProgramInfoLog(*cube_program, 512, NULL, info_log);
-        printf("Cube program linking failed: %s\n", info_log);
-        glDeleteShader(vs);
-        glDeleteShader(fs);
-        return 0;
-    }
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    *cube_program = compile_shader_program(cube_vs_src, cube_fs_src, "Cube");
+    if (!*cube_program) return 0;
+    bind_camera_block(*cube_program);
     return 1;
 }
 
-// Initialize cube (unchanged)
+// Queue the texture and load the cube mesh. The texture decodes on the loader's
+// workers; until it is uploaded render_cube draws with the placeholder.
 int init_cube(const char* texture_path, CubeData* cube_data) {
-    int width, height, channels;
-    unsigned char* image = stbi_load(texture_path, &width, &height, &channels, 4);
-    if (!image) {
-        printf("Error: Failed to load texture '%s'\n", texture_path);
+    cube_data->texture = load_texture_async(texture_path, GL_NEAREST);
+    if (!cube_data->texture) return 0;
+
+    // Cooked from resources/cube.obj by tools/mesh_cooker
+    if (!load_mesh(CUBE_MESH_PATH, &cube_data->mesh)) {
+        release_texture(cube_data->texture);
+        cube_data->texture = NULL;
         return 0;
     }
-    glGenTextures(1, &cube_data->texture);
-    glBindTexture(GL_TEXTURE_2D, cube_data->texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-    // glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    // glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); // Changed to GL_NEAREST
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST); // Changed to GL_NEAREST
-
-    stbi_image_free(image);
-
-    float vertices[] = {
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,  0.0f,  0.0f,  1.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,  0.0f,  0.0f,  1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,  0.0f,  0.0f,  1.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,  0.0f,  0.0f,  1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,  0.0f,  0.0f, -1.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 0.0f,  0.0f,  0.0f, -1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,  0.0f,  0.0f, -1.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,  0.0f,  0.0f, -1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f, -1.0f,  0.0f,  0.0f,
-        -0.5f, -0.5f,  0.5f,  1.0f, 0.0f, -1.0f,  0.0f,  0.0f,
-        -0.5f,  0.5f,  0.5f,  1.0f, 1.0f, -1.0f,  0.0f,  0.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f, -1.0f,  0.0f,  0.0f,
-         0.5f, -0.5f,  0.5f,  0.0f, 0.0f,  1.0f,  0.0f,  0.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 0.0f,  1.0f,  0.0f,  0.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,  1.0f,  0.0f,  0.0f,
-         0.5f,  0.5f,  0.5f,  0.0f, 1.0f,  1.0f,  0.0f,  0.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,  0.0f,  1.0f,  0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,  0.0f,  1.0f,  0.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,  0.0f,  1.0f,  0.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,  0.0f,  1.0f,  0.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,  0.0f, -1.0f,  0.0f,
-         0.5f, -0.5f, -0.5f,  1.0f, 0.0f,  0.0f, -1.0f,  0.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 1.0f,  0.0f, -1.0f,  0.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 1.0f,  0.0f, -1.0f,  0.0f
-    };
-    unsigned int indices[] = {
-        0, 1, 2,  2, 3, 0,
-        4, 5, 6,  6, 7, 4,
-        8, 9, 10, 10, 11, 8,
-        12, 13, 14, 14, 15, 12,
-        16, 17, 18, 18, 19, 16,
-        20, 21, 22, 22, 23, 20
-    };
-    glGenVertexArrays(1, &cube_data->vao);
-    glGenBuffers(1, &cube_data->vbo);
-    GLuint ebo;
-    glGenBuffers(1, &ebo);
-    glBindVertexArray(cube_data->vao);
-    glBindBuffer(GL_ARRAY_BUFFER, cube_data->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    glBindVertexArray(0);
     return 1;
 }
 
-// Render cube with CGLM matrices
+// Uniform indices for the last program passed to render_cube
+static struct {
+    unsigned int serial;
+    int texture, light_pos, light_color, model;
+} cube_uniforms;
+
+// Render cube with CGLM matrices; view and projection come from the camera block
 void render_cube(CubeData* cube_data, GLuint program, vec3 rotation, int ww, int hh) {
-    glUseProgram(program);
-    glUniform1i(glGetUniformLocation(program, "cubeTexture"), 0);
-    glUniform3f(glGetUniformLocation(program, "lightPos"), 0.0f, 0.0f, 3.0f);
-    glUniform3f(glGetUniformLocation(program, "lightColor"), 1.0f, 1.0f, 1.0f);
+    ShaderProgram* shader = get_shader_program(program);
+    if (!shader) return;
+    if (cube_uniforms.serial != shader->serial) {
+        cube_uniforms.serial = shader->serial;
+        cube_uniforms.texture = find_shader_uniform(shader, "cubeTexture");
+        cube_uniforms.light_pos = find_shader_uniform(shader, "lightPos");
+        cube_uniforms.light_color = find_shader_uniform(shader, "lightColor");
+        cube_uniforms.model = find_shader_uniform(shader, "model");
+    }
+    set_camera_viewport(ww, hh);
+    update_camera_buffer();
 
-    mat4 model, view, projection;
+    glstate_use_program(program);
+    set_uniform_int(shader, cube_uniforms.texture, 0);
+    set_uniform_vec3(shader, cube_uniforms.light_pos, 0.0f, 0.0f, 3.0f);
+    set_uniform_vec3(shader, cube_uniforms.light_color, 1.0f, 1.0f, 1.0f);
+
+    mat4 model;
     glm_mat4_identity(model);
     glm_rotate_x(model, glm_rad(rotation[0]), model);
     glm_rotate_y(model, glm_rad(rotation[1]), model);
     glm_rotate_z(model, glm_rad(rotation[2]), model);
-    glm_lookat((vec3){0.0f, 0.0f, 3.0f}, (vec3){0.0f, 0.0f, 0.0f}, (vec3){0.0f, 1.0f, 0.0f}, view);
-    glm_perspective(glm_rad(45.0f), (float)ww / hh, 0.1f, 100.0f, projection);
+    get_mesh_model_matrix(&cube_data->mesh, model, model); // Folds in the position dequantize
+
+    set_uniform_mat4(shader, cube_uniforms.model, (float*)model);
 
-    glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, (float*)model);
-    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, (float*)view);
-    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, (float*)projection);
+    glstate_active_texture(GL_TEXTURE0);
+    glstate_bind_texture(GL_TEXTURE_2D, cube_data->texture->id); // Placeholder until loaded
+    draw_mesh(&cube_data->mesh);
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, cube_data->texture);
-    glBindVertexArray(cube_data->vao);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+void cleanup_cube(CubeData* cube_data) {
+    release_texture(cube_data->texture);
+    cube_data->texture = NULL;
+    cleanup_mesh(&cube_data->mesh);
 }
 
@@ -1,95 +1,1169 @@
 // module_font.c
 #include "module_font.h"
+#include "module_mmap.h"
+#include "module_arena.h"
+#include "module_shader.h"
+#include "module_glstate.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "stb_truetype.h"
 
+#define FONT_ATLAS_SIZE 512     // Atlas page width and height in pixels
+#define FONT_GLYPH_PADDING 1    // Empty pixels kept right/below every glyph
+#define FONT_SDF_PADDING 6      // Distance field spread around each SDF glyph in pixels
+#define FONT_SDF_ONEDGE 128     // SDF value on the glyph outline
+#define FONT_WARM_FIRST 32      // Glyph range rasterized at load (and stored in the cache)
+#define FONT_WARM_LAST 126
+#define FONT_CACHE_VERSION 1    // Bump when FontGlyph, SkylineNode or the rasterizer change
+#define FONT_DRAW_CHUNK 4096    // Max glyphs per render_text draw call; longer text takes several draws
+#define FONT_KERN_ASCII 96      // Codepoints 32..127 use the flat advance and kerning tables
+#define FONT_KERN_MEMO_MAX 65536 // Stop memoizing GPOS pairs beyond this many map entries
+#define FONT_LAYOUT_CACHE 1024  // Paragraph layouts kept per font (power of two)
+#define FONT_LAYOUT_PROBE 4     // Slots searched per layout before the oldest is replaced
+
+// A mapped TTF file shared by every FontData loaded from the same path
+typedef struct FontSource {
+    char* path;
+    MappedFile file;
+    unsigned long long hash;      // FNV-1a of the file, computed once for the atlas cache
+    int refs;
+    struct FontSource* next;
+} FontSource;
+
+// One glyph known to the font. Metrics are kept for the life of the font, the
+// atlas rectangle only while the glyph is resident.
+typedef struct {
+    int codepoint;
+    int glyph_index;              // stbtt glyph index
+    int w, h;                     // Bitmap size (0 for blank glyphs like space)
+    float xoff, yoff;             // Bitmap offset from the pen position
+    float xadvance;               // Pen advance in pixels
+    unsigned short x0, y0;        // Atlas position when resident
+    unsigned int last_used;       // Draw serial of the last use (LRU)
+    int resident;                 // Has a valid atlas rectangle
+} FontGlyph;
+
+// Skyline segment: columns x..x+w are free from height y down
+typedef struct {
+    int x, y, w;
+} SkylineNode;
+
+// Kerning of a glyph index pair outside the ASCII table
+typedef struct {
+    unsigned int key;             // first glyph index << 16 | second glyph index
+    short advance;                // Font units
+    short used;
+} KernPair;
+
+// One word of a paragraph: a run of non-space bytes and the spaces after it
+typedef struct {
+    int start, end;               // Byte range of the word
+    float width;                  // Advance width including kerning inside the word
+    float gap;                    // Width of the spaces after it
+    int line_break;               // A '\n' follows the spaces
+} TextWord;
+
+// Cached paragraph layout. Words are measured once; a new max width only refits lines.
+typedef struct {
+    unsigned long long hash;      // 0 = empty slot
+    char* text;
+    float size;
+    TextWord* words;
+    int word_count, word_capacity;
+    TextLine* lines;
+    int line_capacity;
+    TextLayout layout;            // Result handed out, points into text and lines
+    unsigned int last_used;
+} TextLayoutEntry;
+
 // Define FontData locally
 struct FontData {
-    GLuint texture;         // Font texture ID
-    stbtt_bakedchar* cdata; // Character data (ASCII 32..127)
-    int bitmap_w, bitmap_h; // Bitmap dimensions
+    GLuint texture;               // Font texture ID
+    int bitmap_w, bitmap_h;       // Bitmap dimensions
+    unsigned char* bitmap;        // CPU copy of the atlas, source of dirty uploads
+    int dirty_x0, dirty_y0;       // Atlas area changed since the last upload
+    int dirty_x1, dirty_y1;
+
+    FontSource* source;           // Mapped TTF file, kept for on-demand rasterization
+    stbtt_fontinfo info;
+    float pixel_scale;            // stbtt scale for font_size * scale
+    float pixel_height;           // Size the atlas is rasterized at
+    int sdf;                      // Atlas holds signed distance fields
+
+    SkylineNode* skyline;         // Skyline packer state for the atlas page
+    int skyline_count;
+
+    FontGlyph* glyphs;            // Every glyph seen so far
+    int glyph_count, glyph_capacity;
+    int* glyph_map;               // Open addressing codepoint -> glyph slot + 1 (0 = empty)
+    int map_capacity;             // Power of two
+    int ascii[128];               // Glyph slots for the ASCII fast path, -1 if unknown
+
+    float advance[FONT_KERN_ASCII];   // Pen advance in pixels for codepoints 32..127
+    short* kern_ascii;            // [first - 32][second - 32] kerning in font units, NULL if the font has none
+    KernPair* kern_pairs;         // Open addressing map for every other pair, filled from the kern table
+    int kern_pair_count;          // or memoized on first use
+    int kern_pair_capacity;       // Power of two
+    int kern_complete;            // kern_pairs holds the whole kern table, a miss means no kerning
+    float ascent, descent;        // Pixels above / below (negative) the baseline
+    float line_gap;               // Extra pixels between lines
+
+    TextLayoutEntry* layouts;     // FONT_LAYOUT_CACHE slots, allocated on first layout
+    unsigned int layout_serial;   // Advanced every layout_text call (LRU)
+
+    unsigned int draw_serial;     // Advanced every time queued text has been drawn
+    int pending_batches;          // Text batches holding undrawn glyphs of this font
+    unsigned int atlas_epoch;     // Advanced on eviction; retained text re-lays out when it changes
 };
 
 // Static FontData for alternative functions
 static struct FontData* global_font_data = NULL;
 
-// Initialize font: Load TTF and bake bitmap
-int init_font(const char* font_path, float font_size, float scale, FontData** font_data) {
-    *font_data = (struct FontData*)malloc(sizeof(struct FontData));
+// Baked atlas cache: header, FontGlyph[glyph_count], SkylineNode[skyline_count], bitmap
+typedef struct {
+    char magic[4];                // "FNTC"
+    unsigned int version;         // FONT_CACHE_VERSION
+    unsigned long long font_hash; // FNV-1a of the TTF bytes
+    float pixel_height;           // font_size * scale
+    int sdf;
+    int first_char, last_char;    // Warmed glyph range
+    int bitmap_w, bitmap_h;
+    int glyph_count;
+    int skyline_count;
+} FontCacheHeader;
+
+static char font_cache_dir[256] = "cache";
+
+// Open font sources; fonts of the same face share one mapping
+static FontSource* font_sources = NULL;
+
+// Vertex storage for render_text, rewound after every call
+static FrameArena* text_arena = NULL;
+
+// Uniform indices for the last program passed to render_text
+static struct {
+    unsigned int serial;
+    int texture, color, sdf;
+} text_uniforms;
+
+static unsigned long long hash_fnv1a(const void* data, size_t size, unsigned long long hash) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Map a TTF file, or take another reference to an existing mapping of it
+static FontSource* acquire_font_source(const char* font_path) {
+    for (FontSource* source = font_sources; source; source = source->next) {
+        if (strcmp(source->path, font_path) == 0) {
+            source->refs++;
+            return source;
+        }
+    }
+
+    FontSource* source = (FontSource*)calloc(1, sizeof(FontSource));
+    if (!source) {
+        printf("Error: Failed to allocate font source\n");
+        return NULL;
+    }
+    source->path = (char*)malloc(strlen(font_path) + 1);
+    if (!source->path) {
+        printf("Error: Failed to allocate font source\n");
+        free(source);
+        return NULL;
+    }
+    strcpy(source->path, font_path);
+    if (!map_file_open(font_path, &source->file) || source->file.size == 0) {
+        printf("Error: Failed to open font file '%s'\n", font_path);
+        if (source->file.data) map_file_close(&source->file);
+        free(source->path);
+        free(source);
+        return NULL;
+    }
+    source->hash = hash_fnv1a(source->file.data, source->file.size, 14695981039346656037ull);
+    source->refs = 1;
+    source->next = font_sources;
+    font_sources = source;
+    return source;
+}
+
+static void release_font_source(FontSource* source) {
+    if (!source || --source->refs > 0) return;
+    for (FontSource** link = &font_sources; *link; link = &(*link)->next) {
+        if (*link == source) {
+            *link = source->next;
+            break;
+        }
+    }
+    map_file_close(&source->file);
+    free(source->path);
+    free(source);
+}
+
+// Decode one UTF-8 sequence and advance *p; malformed input yields U+FFFD
+static int decode_utf8(const char** p) {
+    const unsigned char* s = (const unsigned char*)*p;
+    int cp, len;
+    if (s[0] < 0x80) { cp = s[0]; len = 1; }
+    else if ((s[0] & 0xE0) == 0xC0) { cp = s[0] & 0x1F; len = 2; }
+    else if ((s[0] & 0xF0) == 0xE0) { cp = s[0] & 0x0F; len = 3; }
+    else if ((s[0] & 0xF8) == 0xF0) { cp = s[0] & 0x07; len = 4; }
+    else { *p += 1; return 0xFFFD; }
+
+    for (int i = 1; i < len; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *p += i; // Stop at the bad byte so it is decoded on its own
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    *p += len;
+    return cp;
+}
+
+static unsigned int hash_codepoint(int codepoint) {
+    return (unsigned int)codepoint * 2654435761u;
+}
+
+static int grow_glyph_map(FontData* font_data) {
+    int capacity = font_data->map_capacity ? font_data->map_capacity * 2 : 256;
+    int* map = (int*)calloc(capacity, sizeof(int));
+    if (!map) {
+        printf("Error: Failed to grow glyph map\n");
+        return 0;
+    }
+    for (int i = 0; i < font_data->glyph_count; i++) {
+        unsigned int slot = hash_codepoint(font_data->glyphs[i].codepoint) & (capacity - 1);
+        while (map[slot]) slot = (slot + 1) & (capacity - 1);
+        map[slot] = i + 1;
+    }
+    free(font_data->glyph_map);
+    font_data->glyph_map = map;
+    font_data->map_capacity = capacity;
+    return 1;
+}
+
+static int find_glyph_slot(const FontData* font_data, int codepoint) {
+    if (codepoint >= 0 && codepoint < 128) return font_data->ascii[codepoint];
+    unsigned int mask = font_data->map_capacity - 1;
+    unsigned int slot = hash_codepoint(codepoint) & mask;
+    while (font_data->glyph_map[slot]) {
+        int index = font_data->glyph_map[slot] - 1;
+        if (font_data->glyphs[index].codepoint == codepoint) return index;
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+static void insert_glyph_slot(FontData* font_data, int index) {
+    int codepoint = font_data->glyphs[index].codepoint;
+    if (codepoint >= 0 && codepoint < 128) {
+        font_data->ascii[codepoint] = index;
+    }
+    unsigned int mask = font_data->map_capacity - 1;
+    unsigned int slot = hash_codepoint(codepoint) & mask;
+    while (font_data->glyph_map[slot]) slot = (slot + 1) & mask;
+    font_data->glyph_map[slot] = index + 1;
+}
+
+// Add the metrics record for a codepoint; the bitmap is rasterized separately
+static int add_glyph(FontData* font_data, int codepoint) {
+    if ((font_data->glyph_count + 1) * 2 > font_data->map_capacity && !grow_glyph_map(font_data)) return -1;
+    if (font_data->glyph_count == font_data->glyph_capacity) {
+        int capacity = font_data->glyph_capacity ? font_data->glyph_capacity * 2 : 128;
+        FontGlyph* glyphs = (FontGlyph*)realloc(font_data->glyphs, capacity * sizeof(FontGlyph));
+        if (!glyphs) {
+            printf("Error: Failed to grow glyph table\n");
+            return -1;
+        }
+        font_data->glyphs = glyphs;
+        font_data->glyph_capacity = capacity;
+    }
+
+    int index = font_data->glyph_count++;
+    FontGlyph* glyph = &font_data->glyphs[index];
+    memset(glyph, 0, sizeof(*glyph));
+    glyph->codepoint = codepoint;
+    glyph->glyph_index = stbtt_FindGlyphIndex(&font_data->info, codepoint); // 0 draws the font's missing glyph box
+
+    int advance, lsb, ix0, iy0, ix1, iy1;
+    stbtt_GetGlyphHMetrics(&font_data->info, glyph->glyph_index, &advance, &lsb);
+    stbtt_GetGlyphBitmapBox(&font_data->info, glyph->glyph_index, font_data->pixel_scale, font_data->pixel_scale, &ix0, &iy0, &ix1, &iy1);
+    glyph->w = ix1 - ix0;
+    glyph->h = iy1 - iy0;
+    if (font_data->sdf && glyph->w > 0 && glyph->h > 0) {
+        // Same box stbtt_GetGlyphSDF produces: bitmap box grown by the padding
+        ix0 -= FONT_SDF_PADDING;
+        iy0 -= FONT_SDF_PADDING;
+        glyph->w += 2 * FONT_SDF_PADDING;
+        glyph->h += 2 * FONT_SDF_PADDING;
+    }
+    glyph->xoff = (float)ix0;
+    glyph->yoff = (float)iy0;
+    glyph->xadvance = advance * font_data->pixel_scale;
+    glyph->resident = (glyph->w == 0 || glyph->h == 0); // Blank glyphs need no atlas space
+
+    insert_glyph_slot(font_data, index);
+    return index;
+}
+
+// Skyline packer: check if a w x h rect fits with its left edge at node i
+static int skyline_fit(const FontData* font_data, int i, int w, int h, int* out_y) {
+    if (font_data->skyline[i].x + w > font_data->bitmap_w) return 0;
+    int y = font_data->skyline[i].y;
+    int width_left = w;
+    for (int j = i; width_left > 0; j++) {
+        if (j == font_data->skyline_count) return 0;
+        if (font_data->skyline[j].y > y) y = font_data->skyline[j].y;
+        if (y + h > font_data->bitmap_h) return 0;
+        width_left -= font_data->skyline[j].w;
+    }
+    *out_y = y;
+    return 1;
+}
+
+// Skyline packer: place a rect bottom-left first, returns 0 when the page is full
+static int skyline_insert(FontData* font_data, int w, int h, int* out_x, int* out_y) {
+    int best = -1, best_bottom = INT_MAX, best_width = INT_MAX, best_y = 0;
+    for (int i = 0; i < font_data->skyline_count; i++) {
+        int y;
+        if (skyline_fit(font_data, i, w, h, &y)) {
+            if (y + h < best_bottom || (y + h == best_bottom && font_data->skyline[i].w < best_width)) {
+                best = i;
+                best_bottom = y + h;
+                best_width = font_data->skyline[i].w;
+                best_y = y;
+            }
+        }
+    }
+    if (best < 0) return 0;
+
+    SkylineNode* nodes = font_data->skyline;
+    int x = nodes[best].x;
+
+    // Insert the new segment and trim the segments it now covers
+    memmove(&nodes[best + 1], &nodes[best], (font_data->skyline_count - best) * sizeof(SkylineNode));
+    nodes[best] = (SkylineNode){x, best_y + h, w};
+    font_data->skyline_count++;
+    for (int i = best + 1; i < font_data->skyline_count; i++) {
+        int shrink = nodes[i - 1].x + nodes[i - 1].w - nodes[i].x;
+        if (shrink <= 0) break;
+        nodes[i].x += shrink;
+        nodes[i].w -= shrink;
+        if (nodes[i].w > 0) break;
+        memmove(&nodes[i], &nodes[i + 1], (font_data->skyline_count - i - 1) * sizeof(SkylineNode));
+        font_data->skyline_count--;
+        i--;
+    }
+    // Merge neighbours at the same height
+    for (int i = 0; i < font_data->skyline_count - 1; i++) {
+        if (nodes[i].y == nodes[i + 1].y) {
+            nodes[i].w += nodes[i + 1].w;
+            memmove(&nodes[i + 1], &nodes[i + 2], (font_data->skyline_count - i - 2) * sizeof(SkylineNode));
+            font_data->skyline_count--;
+            i--;
+        }
+    }
+
+    *out_x = x;
+    *out_y = best_y;
+    return 1;
+}
+
+// Rebuild the skyline as the top edge of the glyphs still resident. Glyphs never
+// move, so quads already handed out keep valid UVs.
+static void skyline_rebuild(FontData* font_data) {
+    int* heights = (int*)calloc(font_data->bitmap_w, sizeof(int));
+    if (!heights) return; // Keep the old skyline; it is only less compact
+    for (int i = 0; i < font_data->glyph_count; i++) {
+        const FontGlyph* glyph = &font_data->glyphs[i];
+        if (!glyph->resident || glyph->w == 0 || glyph->h == 0) continue;
+        int bottom = glyph->y0 + glyph->h + FONT_GLYPH_PADDING;
+        int x1 = glyph->x0 + glyph->w + FONT_GLYPH_PADDING;
+        if (x1 > font_data->bitmap_w) x1 = font_data->bitmap_w;
+        for (int x = glyph->x0; x < x1; x++) {
+            if (heights[x] < bottom) heights[x] = bottom;
+        }
+    }
+    font_data->skyline_count = 0;
+    for (int x = 0; x < font_data->bitmap_w; x++) {
+        if (font_data->skyline_count && font_data->skyline[font_data->skyline_count - 1].y == heights[x]) {
+            font_data->skyline[font_data->skyline_count - 1].w++;
+        } else {
+            font_data->skyline[font_data->skyline_count++] = (SkylineNode){x, heights[x], 1};
+        }
+    }
+    free(heights);
+}
+
+typedef struct {
+    unsigned int last_used;
+    int index;
+} GlyphAge;
+
+static int compare_glyph_age(const void* a, const void* b) {
+    unsigned int ua = ((const GlyphAge*)a)->last_used;
+    unsigned int ub = ((const GlyphAge*)b)->last_used;
+    return (ua > ub) - (ua < ub);
+}
+
+// Drop the least recently used quarter of the atlas. Glyphs used by text that
+// has not been drawn yet (last_used == draw_serial) are never evicted.
+static int evict_cold_glyphs(FontData* font_data) {
+    GlyphAge* candidates = (GlyphAge*)malloc(font_data->glyph_count * sizeof(GlyphAge));
+    if (!candidates) return 0;
+    int count = 0;
+    for (int i = 0; i < font_data->glyph_count; i++) {
+        const FontGlyph* glyph = &font_data->glyphs[i];
+        if (glyph->resident && glyph->w > 0 && glyph->h > 0 && glyph->last_used != font_data->draw_serial) {
+            candidates[count++] = (GlyphAge){glyph->last_used, i};
+        }
+    }
+    if (count == 0) {
+        free(candidates);
+        return 0;
+    }
+
+    qsort(candidates, count, sizeof(GlyphAge), compare_glyph_age);
+    int evict = count / 4 > 0 ? count / 4 : 1;
+    for (int i = 0; i < evict; i++) {
+        font_data->glyphs[candidates[i].index].resident = 0;
+    }
+    font_data->atlas_epoch++;
+    free(candidates);
+
+    skyline_rebuild(font_data);
+    return 1;
+}
+
+static void mark_atlas_dirty(FontData* font_data, int x0, int y0, int x1, int y1) {
+    if (x0 < font_data->dirty_x0) font_data->dirty_x0 = x0;
+    if (y0 < font_data->dirty_y0) font_data->dirty_y0 = y0;
+    if (x1 > font_data->dirty_x1) font_data->dirty_x1 = x1;
+    if (y1 > font_data->dirty_y1) font_data->dirty_y1 = y1;
+}
+
+// Give a glyph atlas space and rasterize it into the CPU copy of the atlas
+static int make_glyph_resident(FontData* font_data, FontGlyph* glyph) {
+    int x, y;
+    while (!skyline_insert(font_data, glyph->w + FONT_GLYPH_PADDING, glyph->h + FONT_GLYPH_PADDING, &x, &y)) {
+        if (!evict_cold_glyphs(font_data)) {
+            printf("Warning: Font atlas full, dropping glyph U+%04X\n", glyph->codepoint);
+            return 0;
+        }
+    }
+    glyph->x0 = (unsigned short)x;
+    glyph->y0 = (unsigned short)y;
+    glyph->resident = 1;
+
+    // Clear the rect (evicted glyphs may have left pixels behind) and rasterize
+    int w = glyph->w + FONT_GLYPH_PADDING;
+    int h = glyph->h + FONT_GLYPH_PADDING;
+    if (x + w > font_data->bitmap_w) w = font_data->bitmap_w - x;
+    if (y + h > font_data->bitmap_h) h = font_data->bitmap_h - y;
+    for (int row = 0; row < h; row++) {
+        memset(font_data->bitmap + (y + row) * font_data->bitmap_w + x, 0, w);
+    }
+    if (font_data->sdf) {
+        int sdf_w, sdf_h, sdf_xoff, sdf_yoff;
+        unsigned char* sdf = stbtt_GetGlyphSDF(&font_data->info, font_data->pixel_scale, glyph->glyph_index, FONT_SDF_PADDING,
+                                               FONT_SDF_ONEDGE, (float)FONT_SDF_ONEDGE / FONT_SDF_PADDING, &sdf_w, &sdf_h, &sdf_xoff, &sdf_yoff);
+        if (sdf) {
+            int copy_w = sdf_w < glyph->w ? sdf_w : glyph->w;
+            int copy_h = sdf_h < glyph->h ? sdf_h : glyph->h;
+            for (int row = 0; row < copy_h; row++) {
+                memcpy(font_data->bitmap + (y + row) * font_data->bitmap_w + x, sdf + row * sdf_w, copy_w);
+            }
+            stbtt_FreeSDF(sdf, NULL);
+        }
+    } else {
+        stbtt_MakeGlyphBitmap(&font_data->info, font_data->bitmap + y * font_data->bitmap_w + x, glyph->w, glyph->h, font_data->bitmap_w,
+                              font_data->pixel_scale, font_data->pixel_scale, glyph->glyph_index);
+    }
+    mark_atlas_dirty(font_data, x, y, x + w, y + h);
+    return 1;
+}
+
+// Look up a glyph, rasterizing it on first use. Returns NULL only when the glyph
+// cannot be placed; the caller should skip it.
+static FontGlyph* get_glyph(FontData* font_data, int codepoint) {
+    int index = find_glyph_slot(font_data, codepoint);
+    if (index < 0) {
+        index = add_glyph(font_data, codepoint);
+        if (index < 0) return NULL;
+    }
+    FontGlyph* glyph = &font_data->glyphs[index];
+    glyph->last_used = font_data->draw_serial;
+    if (!glyph->resident && !make_glyph_resident(font_data, glyph)) return NULL;
+    return glyph;
+}
+
+// Scale from atlas pixels to a requested text size (0 = the size the font was loaded at)
+static float get_size_scale(const FontData* font_data, float size) {
+    return size > 0.0f ? size / font_data->pixel_height : 1.0f;
+}
+
+static unsigned int hash_kern_key(unsigned int key) {
+    return key * 2654435761u;
+}
+
+static int grow_kern_pairs(FontData* font_data) {
+    int capacity = font_data->kern_pair_capacity ? font_data->kern_pair_capacity * 2 : 256;
+    KernPair* pairs = (KernPair*)calloc(capacity, sizeof(KernPair));
+    if (!pairs) {
+        printf("Error: Failed to grow kerning map\n");
+        return 0;
+    }
+    for (int i = 0; i < font_data->kern_pair_capacity; i++) {
+        KernPair* pair = &font_data->kern_pairs[i];
+        if (!pair->used) continue;
+        unsigned int slot = hash_kern_key(pair->key) & (capacity - 1);
+        while (pairs[slot].used) slot = (slot + 1) & (capacity - 1);
+        pairs[slot] = *pair;
+    }
+    free(font_data->kern_pairs);
+    font_data->kern_pairs = pairs;
+    font_data->kern_pair_capacity = capacity;
+    return 1;
+}
+
+static KernPair* find_kern_pair(const FontData* font_data, unsigned int key) {
+    if (!font_data->kern_pairs) return NULL;
+    unsigned int mask = font_data->kern_pair_capacity - 1;
+    unsigned int slot = hash_kern_key(key) & mask;
+    while (font_data->kern_pairs[slot].used) {
+        if (font_data->kern_pairs[slot].key == key) return &font_data->kern_pairs[slot];
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+static void insert_kern_pair(FontData* font_data, unsigned int key, int advance) {
+    if ((font_data->kern_pair_count + 1) * 2 > font_data->kern_pair_capacity && !grow_kern_pairs(font_data)) return;
+    unsigned int mask = font_data->kern_pair_capacity - 1;
+    unsigned int slot = hash_kern_key(key) & mask;
+    while (font_data->kern_pairs[slot].used) {
+        if (font_data->kern_pairs[slot].key == key) return;
+        slot = (slot + 1) & mask;
+    }
+    font_data->kern_pairs[slot].key = key;
+    font_data->kern_pairs[slot].advance = (short)advance;
+    font_data->kern_pairs[slot].used = 1;
+    font_data->kern_pair_count++;
+}
+
+// Build the ASCII advance table and the kerning tables once at load, so layout never
+// walks the TrueType kern/GPOS tables per glyph pair
+static int init_font_metrics(FontData* font_data) {
+    stbtt_fontinfo* info = &font_data->info;
+    int ascii_glyphs[FONT_KERN_ASCII];
+    for (int i = 0; i < FONT_KERN_ASCII; i++) {
+        int advance, lsb;
+        ascii_glyphs[i] = stbtt_FindGlyphIndex(info, 32 + i);
+        stbtt_GetGlyphHMetrics(info, ascii_glyphs[i], &advance, &lsb);
+        font_data->advance[i] = advance * font_data->pixel_scale;
+    }
+    int ascent, descent, line_gap;
+    stbtt_GetFontVMetrics(info, &ascent, &descent, &line_gap);
+    font_data->ascent = ascent * font_data->pixel_scale;
+    font_data->descent = descent * font_data->pixel_scale;
+    font_data->line_gap = line_gap * font_data->pixel_scale;
+
+    if (!info->kern && !info->gpos) return 1; // No kerning at all
+
+    int table_length = stbtt_GetKerningTableLength(info);
+    if (table_length > 0) {
+        stbtt_kerningentry* table = (stbtt_kerningentry*)malloc(table_length * sizeof(stbtt_kerningentry));
+        if (!table) {
+            printf("Error: Failed to allocate kerning table\n");
+            return 0;
+        }
+        table_length = stbtt_GetKerningTable(info, table, table_length);
+        for (int i = 0; i < table_length; i++) {
+            insert_kern_pair(font_data, (unsigned int)table[i].glyph1 << 16 | (unsigned int)table[i].glyph2, table[i].advance);
+        }
+        free(table);
+        font_data->kern_complete = !info->gpos; // GPOS pairs still have to be looked up on demand
+    }
+
+    font_data->kern_ascii = (short*)calloc(FONT_KERN_ASCII * FONT_KERN_ASCII, sizeof(short));
+    if (!font_data->kern_ascii) {
+        printf("Error: Failed to allocate kerning table\n");
+        return 0;
+    }
+    for (int a = 0; a < FONT_KERN_ASCII; a++) {
+        for (int b = 0; b < FONT_KERN_ASCII; b++) {
+            int advance;
+            if (font_data->kern_complete) {
+                KernPair* pair = find_kern_pair(font_data, (unsigned int)ascii_glyphs[a] << 16 | (unsigned int)ascii_glyphs[b]);
+                advance = pair ? pair->advance : 0;
+            } else {
+                advance = stbtt_GetGlyphKernAdvance(info, ascii_glyphs[a], ascii_glyphs[b]);
+            }
+            font_data->kern_ascii[a * FONT_KERN_ASCII + b] = (short)advance;
+        }
+    }
+    return 1;
+}
+
+// Kerning in atlas pixels between two glyphs drawn in a row. O(1): ASCII pairs come
+// from the flat table, others from the pair map (memoized on the first miss).
+static float get_kerning(FontData* font_data, int first_codepoint, int first_glyph, int second_codepoint, int second_glyph) {
+    if (!font_data->kern_ascii) return 0.0f;
+    if (first_codepoint >= 32 && first_codepoint < 32 + FONT_KERN_ASCII &&
+        second_codepoint >= 32 && second_codepoint < 32 + FONT_KERN_ASCII) {
+        return font_data->kern_ascii[(first_codepoint - 32) * FONT_KERN_ASCII + second_codepoint - 32] * font_data->pixel_scale;
+    }
+    unsigned int key = (unsigned int)first_glyph << 16 | (unsigned int)second_glyph;
+    KernPair* pair = find_kern_pair(font_data, key);
+    if (pair) return pair->advance * font_data->pixel_scale;
+    if (font_data->kern_complete) return 0.0f;
+
+    int advance = stbtt_GetGlyphKernAdvance(&font_data->info, first_glyph, second_glyph);
+    if (font_data->kern_pair_count < FONT_KERN_MEMO_MAX) insert_kern_pair(font_data, key, advance);
+    return advance * font_data->pixel_scale;
+}
+
+// Screen-space quad for a glyph at the pen position. At native size this matches the
+// pixel snapping of stbtt_GetBakedQuad; scaled text keeps exact positions.
+static void get_glyph_quad(const FontData* font_data, const FontGlyph* glyph, float size_scale, float* x, float* y, stbtt_aligned_quad* q) {
+    float ipw = 1.0f / font_data->bitmap_w;
+    float iph = 1.0f / font_data->bitmap_h;
+    if (size_scale == 1.0f && !font_data->sdf) {
+        float round_x = (float)(int)(*x + glyph->xoff + 0.5f);
+        float round_y = (float)(int)(*y + glyph->yoff + 0.5f);
+        q->x0 = round_x;
+        q->y0 = round_y;
+        q->x1 = round_x + glyph->w;
+        q->y1 = round_y + glyph->h;
+    } else {
+        q->x0 = *x + glyph->xoff * size_scale;
+        q->y0 = *y + glyph->yoff * size_scale;
+        q->x1 = q->x0 + glyph->w * size_scale;
+        q->y1 = q->y0 + glyph->h * size_scale;
+    }
+    q->s0 = glyph->x0 * ipw;
+    q->t0 = glyph->y0 * iph;
+    q->s1 = (glyph->x0 + glyph->w) * ipw;
+    q->t1 = (glyph->y0 + glyph->h) * iph;
+    *x += glyph->xadvance * size_scale;
+}
+
+// Text using the current serial has been drawn. While a batch still holds queued
+// glyphs of this font they stay pinned until that batch is flushed.
+static void release_pinned_glyphs(FontData* font_data) {
+    if (font_data->pending_batches == 0) font_data->draw_serial++;
+}
+
+// Push rasterized glyphs to the texture: one glTexSubImage2D of the dirty rectangle
+static void upload_font_atlas(FontData* font_data) {
+    if (font_data->dirty_x1 <= font_data->dirty_x0 || font_data->dirty_y1 <= font_data->dirty_y0) return;
+    glstate_bind_texture(GL_TEXTURE_2D, font_data->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, font_data->bitmap_w);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, font_data->dirty_x0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, font_data->dirty_y0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, font_data->dirty_x0, font_data->dirty_y0,
+                    font_data->dirty_x1 - font_data->dirty_x0, font_data->dirty_y1 - font_data->dirty_y0,
+                    GL_RED, GL_UNSIGNED_BYTE, font_data->bitmap);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    font_data->dirty_x0 = font_data->bitmap_w;
+    font_data->dirty_y0 = font_data->bitmap_h;
+    font_data->dirty_x1 = 0;
+    font_data->dirty_y1 = 0;
+}
+
+// Set where baked atlases are cached; NULL or "" disables the cache
+void set_font_cache_dir(const char* dir) {
+    snprintf(font_cache_dir, sizeof(font_cache_dir), "%s", dir ? dir : "");
+}
+
+
+// Cache key header for the font as it is being loaded (counts filled in on save)
+static FontCacheHeader make_cache_header(const FontData* font_data) {
+    FontCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "FNTC", 4);
+    header.version = FONT_CACHE_VERSION;
+    header.font_hash = font_data->source->hash;
+    header.pixel_height = font_data->pixel_height;
+    header.sdf = font_data->sdf;
+    header.first_char = FONT_WARM_FIRST;
+    header.last_char = FONT_WARM_LAST;
+    header.bitmap_w = font_data->bitmap_w;
+    header.bitmap_h = font_data->bitmap_h;
+    return header;
+}
+
+static void get_cache_path(const FontCacheHeader* key, char* path, size_t size) {
+    unsigned long long id = hash_fnv1a(key, offsetof(FontCacheHeader, glyph_count), 14695981039346656037ull);
+    snprintf(path, size, "%s/font_%016llx.bin", font_cache_dir, id);
+}
+
+// Restore a baked atlas. The texture is uploaded straight from the mapped file.
+static int load_font_cache(FontData* font_data, const FontCacheHeader* key) {
+    if (!font_cache_dir[0]) return 0;
+    char path[320];
+    get_cache_path(key, path, sizeof(path));
+
+    MappedFile file;
+    if (!map_file_open(path, &file)) return 0;
+
+    const FontCacheHeader* header = (const FontCacheHeader*)file.data;
+    size_t bitmap_size = (size_t)font_data->bitmap_w * font_data->bitmap_h;
+    if (file.size < sizeof(FontCacheHeader) ||
+        memcmp(header, key, offsetof(FontCacheHeader, glyph_count)) != 0 ||
+        header->glyph_count < 0 || header->skyline_count <= 0 || header->skyline_count > font_data->bitmap_w ||
+        file.size != sizeof(FontCacheHeader) + header->glyph_count * sizeof(FontGlyph) +
+                     header->skyline_count * sizeof(SkylineNode) + bitmap_size) {
+        printf("Font cache '%s' is stale, rebuilding\n", path);
+        map_file_close(&file);
+        return 0;
+    }
+
+    const unsigned char* cursor = file.data + sizeof(FontCacheHeader);
+    const FontGlyph* glyphs = (const FontGlyph*)cursor;
+    cursor += header->glyph_count * sizeof(FontGlyph);
+    const SkylineNode* skyline = (const SkylineNode*)cursor;
+    cursor += header->skyline_count * sizeof(SkylineNode);
+    const unsigned char* bitmap = cursor;
+
+    for (int i = 0; i < header->glyph_count; i++) {
+        int index = font_data->glyph_count;
+        if ((index + 1) * 2 > font_data->map_capacity && !grow_glyph_map(font_data)) break;
+        if (index == font_data->glyph_capacity) {
+            int capacity = font_data->glyph_capacity ? font_data->glyph_capacity * 2 : 128;
+            FontGlyph* grown = (FontGlyph*)realloc(font_data->glyphs, capacity * sizeof(FontGlyph));
+            if (!grown) break;
+            font_data->glyphs = grown;
+            font_data->glyph_capacity = capacity;
+        }
+        font_data->glyphs[index] = glyphs[i];
+        font_data->glyphs[index].last_used = 0;
+        font_data->glyph_count++;
+        insert_glyph_slot(font_data, index);
+    }
+    memcpy(font_data->skyline, skyline, header->skyline_count * sizeof(SkylineNode));
+    font_data->skyline_count = header->skyline_count;
+
+    glGenTextures(1, &font_data->texture);
+    glstate_bind_texture(GL_TEXTURE_2D, font_data->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, font_data->bitmap_w, font_data->bitmap_h, 0, GL_RED, GL_UNSIGNED_BYTE, bitmap);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    memcpy(font_data->bitmap, bitmap, bitmap_size); // CPU copy for later dirty uploads
+
+    map_file_close(&file);
+    return 1;
+}
+
+// Write the freshly warmed atlas so later runs skip rasterization
+static void save_font_cache(const FontData* font_data, const FontCacheHeader* key) {
+    if (!font_cache_dir[0] || !make_directory(font_cache_dir)) return;
+    char path[320], temp_path[330];
+    get_cache_path(key, path, sizeof(path));
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    FontCacheHeader header = *key;
+    header.glyph_count = font_data->glyph_count;
+    header.skyline_count = font_data->skyline_count;
+
+    FILE* ff = fopen(temp_path, "wb");
+    if (!ff) {
+        printf("Warning: Failed to write font cache '%s'\n", temp_path);
+        return;
+    }
+    size_t bitmap_size = (size_t)font_data->bitmap_w * font_data->bitmap_h;
+    int ok = fwrite(&header, sizeof(header), 1, ff) == 1 &&
+             fwrite(font_data->glyphs, sizeof(FontGlyph), font_data->glyph_count, ff) == (size_t)font_data->glyph_count &&
+             fwrite(font_data->skyline, sizeof(SkylineNode), font_data->skyline_count, ff) == (size_t)font_data->skyline_count &&
+             fwrite(font_data->bitmap, 1, bitmap_size, ff) == bitmap_size;
+    ok = (fclose(ff) == 0) && ok;
+    remove(path); // rename does not replace on Windows
+    if (!ok || rename(temp_path, path) != 0) {
+        printf("Warning: Failed to write font cache '%s'\n", path);
+        remove(temp_path);
+    }
+}
+
+// Load TTF and create an empty dynamic atlas. Glyphs are rasterized the first
+// time they are drawn; ASCII is warmed up front.
+static int create_font(const char* font_path, float pixel_height, int sdf, FontData** font_data) {
+    *font_data = (struct FontData*)calloc(1, sizeof(struct FontData));
     if (!*font_data) {
         printf("Error: Failed to allocate FontData\n");
         return 0;
     }
+    FontData* font = *font_data;
 
-    unsigned char* ttf_buffer = (unsigned char*)malloc(1 << 20);
-    if (!ttf_buffer) {
-        printf("Error: Failed to allocate TTF buffer\n");
-        free(*font_data);
+    // Map the whole file instead of copying it; sizes of one face share the mapping
+    font->source = acquire_font_source(font_path);
+    if (!font->source) {
+        cleanup_font(font);
         *font_data = NULL;
         return 0;
     }
 
-    FILE* ff = fopen(font_path, "rb");
-    if (!ff) {
-        printf("Error: Failed to open font file '%s'\n", font_path);
-        free(ttf_buffer);
-        free(*font_data);
+    const unsigned char* ttf = font->source->file.data;
+    int offset = stbtt_GetFontOffsetForIndex(ttf, 0);
+    if (offset < 0 || !stbtt_InitFont(&font->info, ttf, offset)) {
+        printf("Error: Failed to parse font file '%s'\n", font_path);
+        cleanup_font(font);
         *font_data = NULL;
         return 0;
     }
+    font->pixel_height = pixel_height;
+    font->pixel_scale = stbtt_ScaleForPixelHeight(&font->info, pixel_height);
+    font->sdf = sdf;
 
-    fread(ttf_buffer, 1, 1 << 20, ff);
-    fclose(ff);
-
-    (*font_data)->bitmap_w = 512;
-    (*font_data)->bitmap_h = 512;
-    unsigned char* bitmap = (unsigned char*)malloc((*font_data)->bitmap_w * (*font_data)->bitmap_h);
-    if (!bitmap) {
-        printf("Error: Failed to allocate bitmap\n");
-        free(ttf_buffer);
-        free(*font_data);
+    font->bitmap_w = FONT_ATLAS_SIZE;
+    font->bitmap_h = FONT_ATLAS_SIZE;
+    font->bitmap = (unsigned char*)calloc(font->bitmap_w * font->bitmap_h, 1);
+    font->skyline = (SkylineNode*)malloc(font->bitmap_w * sizeof(SkylineNode));
+    if (!font->bitmap || !font->skyline || !grow_glyph_map(font)) {
+        printf("Error: Failed to allocate font atlas\n");
+        cleanup_font(font);
         *font_data = NULL;
         return 0;
     }
-
-    (*font_data)->cdata = (stbtt_bakedchar*)malloc(96 * sizeof(stbtt_bakedchar));
-    if (!(*font_data)->cdata) {
-        printf("Error: Failed to allocate cdata\n");
-        free(bitmap);
-        free(ttf_buffer);
-        free(*font_data);
+    font->skyline[0] = (SkylineNode){0, 0, font->bitmap_w};
+    font->skyline_count = 1;
+    for (int i = 0; i < 128; i++) font->ascii[i] = -1;
+    if (!init_font_metrics(font)) {
+        cleanup_font(font);
         *font_data = NULL;
         return 0;
     }
 
-    stbtt_BakeFontBitmap(ttf_buffer, 0, font_size * scale, bitmap, (*font_data)->bitmap_w, (*font_data)->bitmap_h, 32, 96, (*font_data)->cdata);
-    free(ttf_buffer);
+    FontCacheHeader cache_key = make_cache_header(font);
+    if (!load_font_cache(font, &cache_key)) {
+        // Warm the printable ASCII range so common text never rasterizes mid-frame
+        for (int c = FONT_WARM_FIRST; c <= FONT_WARM_LAST; c++) {
+            get_glyph(font, c);
+        }
+
+        // Create OpenGL texture
+        glGenTextures(1, &font->texture);
+        glstate_bind_texture(GL_TEXTURE_2D, font->texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, font->bitmap_w, font->bitmap_h, 0, GL_RED, GL_UNSIGNED_BYTE, font->bitmap);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
-    // Create OpenGL texture
-    glGenTextures(1, &(*font_data)->texture);
-    glBindTexture(GL_TEXTURE_2D, (*font_data)->texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, (*font_data)->bitmap_w, (*font_data)->bitmap_h, 0, GL_RED, GL_UNSIGNED_BYTE, bitmap);
+        save_font_cache(font, &cache_key);
+    }
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    free(bitmap);
+    font->dirty_x0 = font->bitmap_w;
+    font->dirty_y0 = font->bitmap_h;
+    font->dirty_x1 = 0;
+    font->dirty_y1 = 0;
 
     return 1;
 }
 
-// Render text
+// Glyph metrics without rasterizing; used by measurement and layout
+static const FontGlyph* get_glyph_metrics(FontData* font_data, int codepoint) {
+    int index = find_glyph_slot(font_data, codepoint);
+    if (index < 0) {
+        index = add_glyph(font_data, codepoint);
+        if (index < 0) return NULL;
+    }
+    return &font_data->glyphs[index];
+}
+
+// Advance the pen over text..end like the draw paths do (kerning, control codes
+// skipped) and grow the ink box. Sizes are in atlas pixels.
+static void measure_range(FontData* font_data, const char* text, const char* end, float* x, int* prev_codepoint, int* prev_glyph, TextBounds* ink) {
+    for (const char* p = text; p < end && *p; ) {
+        int codepoint = decode_utf8(&p);
+        if (codepoint < 32) continue;
+        const FontGlyph* glyph = get_glyph_metrics(font_data, codepoint);
+        if (!glyph) continue;
+        if (*prev_codepoint >= 0) *x += get_kerning(font_data, *prev_codepoint, *prev_glyph, codepoint, glyph->glyph_index);
+        *prev_codepoint = codepoint;
+        *prev_glyph = glyph->glyph_index;
+
+        if (ink && glyph->w > 0 && glyph->h > 0) {
+            float pad = font_data->sdf ? (float)FONT_SDF_PADDING : 0.0f; // Distance field spread is not ink
+            float x0 = *x + glyph->xoff + pad, y0 = glyph->yoff + pad;
+            float x1 = *x + glyph->xoff + glyph->w - pad, y1 = glyph->yoff + glyph->h - pad;
+            if (ink->x0 > ink->x1) {
+                ink->x0 = x0; ink->y0 = y0; ink->x1 = x1; ink->y1 = y1;
+            } else {
+                if (x0 < ink->x0) ink->x0 = x0;
+                if (y0 < ink->y0) ink->y0 = y0;
+                if (x1 > ink->x1) ink->x1 = x1;
+                if (y1 > ink->y1) ink->y1 = y1;
+            }
+        }
+        if (codepoint < 128 && codepoint >= 32) *x += font_data->advance[codepoint - 32];
+        else *x += glyph->xadvance;
+    }
+}
+
+// Advance width of a single line of text; no GL calls
+float measure_text(FontData* font_data, const char* text, float size, TextBounds* bounds) {
+    if (bounds) memset(bounds, 0, sizeof(*bounds));
+    if (!font_data || !text) return 0.0f;
+
+    float size_scale = get_size_scale(font_data, size);
+    float x = 0.0f;
+    int prev_codepoint = -1, prev_glyph = 0;
+    TextBounds ink = { 1.0f, 0.0f, 0.0f, 0.0f }; // x0 > x1 marks it empty
+    measure_range(font_data, text, text + strlen(text), &x, &prev_codepoint, &prev_glyph, &ink);
+
+    if (bounds && ink.x0 <= ink.x1) {
+        bounds->x0 = ink.x0 * size_scale;
+        bounds->y0 = ink.y0 * size_scale;
+        bounds->x1 = ink.x1 * size_scale;
+        bounds->y1 = ink.y1 * size_scale;
+    }
+    return x * size_scale;
+}
+
+// Distance between baselines at a pixel size (0 = size the font was loaded at)
+float get_font_line_height(FontData* font_data, float size) {
+    if (!font_data) return 0.0f;
+    return (font_data->ascent - font_data->descent + font_data->line_gap) * get_size_scale(font_data, size);
+}
+
+// Split text into words and measure each once (in atlas pixels)
+static int measure_words(FontData* font_data, TextLayoutEntry* entry) {
+    const char* text = entry->text;
+    const char* p = text;
+    float x = 0.0f;
+    int prev_codepoint = -1, prev_glyph = 0;
+    entry->word_count = 0;
+
+    for (;;) {
+        if (entry->word_count == entry->word_capacity) {
+            int capacity = entry->word_capacity ? entry->word_capacity * 2 : 16;
+            TextWord* words = (TextWord*)realloc(entry->words, capacity * sizeof(TextWord));
+            if (!words) {
+                printf("Error: Failed to grow text layout\n");
+                return 0;
+            }
+            entry->words = words;
+            entry->word_capacity = capacity;
+        }
+        TextWord* word = &entry->words[entry->word_count++];
+
+        const char* start = p;
+        while (*p && *p != ' ' && *p != '\n') p++;
+        float word_x = x;
+        measure_range(font_data, start, p, &x, &prev_codepoint, &prev_glyph, NULL);
+        word->start = (int)(start - text);
+        word->end = (int)(p - text);
+        word->width = x - word_x;
+
+        start = p;
+        while (*p == ' ') p++;
+        float gap_x = x;
+        measure_range(font_data, start, p, &x, &prev_codepoint, &prev_glyph, NULL);
+        word->gap = x - gap_x;
+
+        word->line_break = (*p == '\n');
+        if (!*p) break;
+        if (word->line_break) {
+            p++;
+            prev_codepoint = -1; // Each line is drawn on its own, no kerning across the break
+        }
+    }
+    return 1;
+}
+
+// Greedy line fitting over the measured words; no glyph lookups
+static int fit_lines(FontData* font_data, TextLayoutEntry* entry, float max_width) {
+    float size_scale = get_size_scale(font_data, entry->size);
+    float limit = max_width / size_scale; // Words are in atlas pixels
+    TextLayout* layout = &entry->layout;
+    layout->line_count = 0;
+    layout->width = 0.0f;
+
+    for (int i = 0; i < entry->word_count; ) {
+        int j = i;
+        float width = entry->words[i].width;
+        while (!entry->words[j].line_break && j + 1 < entry->word_count) {
+            float next = width + entry->words[j].gap + entry->words[j + 1].width;
+            if (max_width > 0.0f && next > limit) break; // A word wider than the limit gets its own line
+            width = next;
+            j++;
+        }
+
+        if (layout->line_count == entry->line_capacity) {
+            int capacity = entry->line_capacity ? entry->line_capacity * 2 : 8;
+            TextLine* lines = (TextLine*)realloc(entry->lines, capacity * sizeof(TextLine));
+            if (!lines) {
+                printf("Error: Failed to grow text layout\n");
+                return 0;
+            }
+            entry->lines = lines;
+            entry->line_capacity = capacity;
+        }
+        TextLine* line = &entry->lines[layout->line_count++];
+        line->start = entry->words[i].start;
+        line->length = entry->words[j].end - entry->words[i].start;
+        line->width = width * size_scale;
+        if (line->width > layout->width) layout->width = line->width;
+        i = j + 1;
+    }
+
+    layout->lines = entry->lines;
+    layout->max_width = max_width;
+    layout->line_height = get_font_line_height(font_data, entry->size);
+    layout->height = layout->line_count * layout->line_height;
+    return 1;
+}
+
+static unsigned long long hash_layout_key(const char* text, size_t len, float size) {
+    unsigned long long hash = hash_fnv1a(text, len, 14695981039346656037ull);
+    hash = hash_fnv1a(&size, sizeof(size), hash);
+    return hash ? hash : 1; // 0 marks an empty slot
+}
+
+// Word-wrapped paragraph layout; no GL calls. Lines break at spaces to fit max_width
+// (0 = only at '\n'). Results are cached per string: the same text and size returns
+// the cached layout, and a different max_width only refits the measured words.
+// The returned layout stays valid until a later layout_text call on this font.
+const TextLayout* layout_text(FontData* font_data, const char* text, float size, float max_width) {
+    if (!font_data || !text) return NULL;
+
+    if (!font_data->layouts) {
+        font_data->layouts = (TextLayoutEntry*)calloc(FONT_LAYOUT_CACHE, sizeof(TextLayoutEntry));
+        if (!font_data->layouts) {
+            printf("Error: Failed to allocate text layout cache\n");
+            return NULL;
+        }
+    }
+    font_data->layout_serial++;
+
+    size_t len = strlen(text);
+    unsigned long long hash = hash_layout_key(text, len, size);
+    TextLayoutEntry* entry = NULL;
+    TextLayoutEntry* oldest = NULL;
+    for (int i = 0; i < FONT_LAYOUT_PROBE; i++) {
+        TextLayoutEntry* slot = &font_data->layouts[(hash + i) & (FONT_LAYOUT_CACHE - 1)];
+        if (slot->hash == hash && slot->size == size && strcmp(slot->text, text) == 0) {
+            entry = slot;
+            break;
+        }
+        if (!oldest || !slot->hash || (oldest->hash && slot->last_used < oldest->last_used)) oldest = slot;
+    }
+
+    if (entry) {
+        entry->last_used = font_data->layout_serial;
+        if (entry->layout.max_width != max_width && !fit_lines(font_data, entry, max_width)) return NULL;
+        return &entry->layout;
+    }
+
+    // Replace the least recently used slot, keeping its arrays for reuse
+    entry = oldest;
+    char* copy = (char*)realloc(entry->text, len + 1);
+    if (!copy) {
+        printf("Error: Failed to allocate text layout\n");
+        return NULL;
+    }
+    memcpy(copy, text, len + 1);
+    entry->text = copy;
+    entry->hash = 0;
+    entry->size = size;
+    entry->layout.text = entry->text;
+    if (!measure_words(font_data, entry) || !fit_lines(font_data, entry, max_width)) return NULL;
+    entry->hash = hash;
+    entry->last_used = font_data->layout_serial;
+    return &entry->layout;
+}
+
+static void free_text_layouts(FontData* font_data) {
+    if (!font_data->layouts) return;
+    for (int i = 0; i < FONT_LAYOUT_CACHE; i++) {
+        free(font_data->layouts[i].text);
+        free(font_data->layouts[i].words);
+        free(font_data->layouts[i].lines);
+    }
+    free(font_data->layouts);
+}
+
+// Initialize font: coverage bitmaps rasterized at font_size * scale
+int init_font(const char* font_path, float font_size, float scale, FontData** font_data) {
+    return create_font(font_path, font_size * scale, 0, font_data);
+}
+
+// Initialize SDF font: one distance-field atlas at base_size that renders crisply at
+// any size through render_text_sized / queue_text_sized
+int init_font_sdf(const char* font_path, float base_size, FontData** font_data) {
+    return create_font(font_path, base_size, 1, font_data);
+}
+
+// Render text (UTF-8)
 void render_text(FontData* font_data, GLuint program, GLuint vao, GLuint vbo, const char* text, float x, float y, int ww, int hh, float r, float g, float b, float a) {
+    render_text_sized(font_data, program, vao, vbo, text, x, y, 0.0f, ww, hh, r, g, b, a);
+}
+
+// Render text at a pixel size (0 = size the font was loaded at)
+void render_text_sized(FontData* font_data, GLuint program, GLuint vao, GLuint vbo, const char* text, float x, float y, float size, int ww, int hh, float r, float g, float b, float a) {
     if (!font_data) return;
 
-    float vertices[1024 * 4]; // Enough for simple text
-    int vert_count = 0;
+    float size_scale = get_size_scale(font_data, size);
+
+    if (!text_arena && !init_frame_arena(FONT_DRAW_CHUNK * 24 * sizeof(float), &text_arena)) return;
+
+    // Every byte is at most one glyph, so this bounds the chunk without decoding twice
+    size_t text_len = strlen(text);
+    int chunk_glyphs = text_len < FONT_DRAW_CHUNK ? (int)text_len : FONT_DRAW_CHUNK;
+    if (chunk_glyphs == 0) return;
+
+    FrameArenaMark mark = frame_arena_mark(text_arena);
+    float* vertices = (float*)frame_arena_alloc(text_arena, chunk_glyphs * 24 * sizeof(float));
+    if (!vertices) return;
+
+    ShaderProgram* shader = get_shader_program(program);
+    if (!shader) {
+        frame_arena_rewind(text_arena, mark);
+        return;
+    }
+    if (text_uniforms.serial != shader->serial) {
+        text_uniforms.serial = shader->serial;
+        text_uniforms.texture = find_shader_uniform(shader, "textTexture");
+        text_uniforms.color = find_shader_uniform(shader, "textColor");
+        text_uniforms.sdf = find_shader_uniform(shader, "sdfMode");
+    }
+    glstate_use_program(program);
+    set_uniform_int(shader, text_uniforms.texture, 0);
+    set_uniform_vec4(shader, text_uniforms.color, r, g, b, a);
+    set_uniform_int(shader, text_uniforms.sdf, font_data->sdf);
+    glstate_active_texture(GL_TEXTURE0);
+    glstate_bind_vertex_array(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    const char* p = text;
+    int prev_codepoint = -1, prev_glyph = 0; // Kerning carries across chunks
+    while (*p) {
+        int vert_count = 0;
+
+        while (*p && vert_count < chunk_glyphs * 24) {
+            int codepoint = decode_utf8(&p);
+            if (codepoint < 32) continue;
+            FontGlyph* glyph = get_glyph(font_data, codepoint);
+            if (!glyph) continue;
+            if (prev_codepoint >= 0) x += get_kerning(font_data, prev_codepoint, prev_glyph, codepoint, glyph->glyph_index) * size_scale;
+            prev_codepoint = codepoint;
+            prev_glyph = glyph->glyph_index;
 
-    for (const char* p = text; *p; p++) {
-        if (*p >= 32 && *p < 128) {
             stbtt_aligned_quad q;
-            stbtt_GetBakedQuad(font_data->cdata, font_data->bitmap_w, font_data->bitmap_h, *p - 32, &x, &y, &q, 1);
+            get_glyph_quad(font_data, glyph, size_scale, &x, &y, &q);
+            if (glyph->w == 0 || glyph->h == 0) continue;
 
             float nx0 = 2.0f * q.x0 / ww - 1.0f;
             float ny0 = 1.0f - 2.0f * q.y0 / hh;
@@ -106,27 +1180,528 @@ void render_text(FontData* font_data, GLuint program, GLuint vao, GLuint vbo, co
             vertices[vert_count++] = nx1; vertices[vert_count++] = ny1; vertices[vert_count++] = q.s1; vertices[vert_count++] = q.t1;
             vertices[vert_count++] = nx0; vertices[vert_count++] = ny1; vertices[vert_count++] = q.s0; vertices[vert_count++] = q.t1;
         }
+        if (vert_count == 0) break;
+
+        upload_font_atlas(font_data);
+        glstate_bind_texture(GL_TEXTURE_2D, font_data->texture);
+        // glBufferData orphans the previous chunk so the driver does not wait on its draw
+        glBufferData(GL_ARRAY_BUFFER, vert_count * sizeof(float), vertices, GL_DYNAMIC_DRAW);
+        glDrawArrays(GL_TRIANGLES, 0, vert_count / 4);
+
+        // Drawn glyphs may make room for the next chunk, so long text can cycle through the atlas
+        release_pinned_glyphs(font_data);
     }
 
-    glUseProgram(program);
-    glUniform1i(glGetUniformLocation(program, "textTexture"), 0);
-    glUniform4f(glGetUniformLocation(program, "textColor"), r, g, b, a);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, font_data->texture);
+    frame_arena_rewind(text_arena, mark);
+}
+
+// Batched text: one instance per glyph, the vertex shader expands the four corners
+// and converts pixels to NDC (28 bytes per glyph instead of six vertices)
+typedef struct {
+    float x0, y0, x1, y1;           // Pixel rect, origin top-left
+    unsigned short s0, t0, s1, t1;  // Atlas UV rect as unorm16
+    unsigned int color;             // Packed RGBA8
+} TextGlyphInstance;
 
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vert_count * sizeof(float), vertices, GL_DYNAMIC_DRAW);
-    glDrawArrays(GL_TRIANGLES, 0, vert_count / 4);
-    glBindVertexArray(0);
+#define TEXT_BATCH_MAX_FONTS 8
+
+// Queued glyphs for one font atlas
+typedef struct {
+    FontData* font;
+    TextGlyphInstance* glyphs;
+    int count, capacity;
+} TextBatchBucket;
+
+struct TextBatch {
+    ShaderProgram* shader;
+    GLuint vao, vbo;
+    int texture_uniform;    // Uniform indices in shader
+    int sdf_uniform;
+    int viewport_uniform;
+    int offset_uniform;
+    GLsizeiptr vbo_size;    // Current size of the streaming buffer in bytes
+    int ww, hh;             // Viewport size for the current batch
+    TextBatchBucket buckets[TEXT_BATCH_MAX_FONTS];
+    int bucket_count;
+};
+
+static unsigned int pack_color(float r, float g, float b, float a) {
+    unsigned int cr = (unsigned int)(r * 255.0f + 0.5f) & 0xFF;
+    unsigned int cg = (unsigned int)(g * 255.0f + 0.5f) & 0xFF;
+    unsigned int cb = (unsigned int)(b * 255.0f + 0.5f) & 0xFF;
+    unsigned int ca = (unsigned int)(a * 255.0f + 0.5f) & 0xFF;
+    return cr | (cg << 8) | (cb << 16) | (ca << 24); // Byte order R, G, B, A in memory
+}
+
+// Find the bucket for a font atlas, adding one if this font is new to the batch
+static TextBatchBucket* get_batch_bucket(TextBatch* batch, FontData* font_data) {
+    for (int i = 0; i < batch->bucket_count; i++) {
+        if (batch->buckets[i].font == font_data) return &batch->buckets[i];
+    }
+    if (batch->bucket_count == TEXT_BATCH_MAX_FONTS) {
+        // Out of buckets: draw what we have and start over
+        flush_text_batch(batch);
+    }
+    TextBatchBucket* bucket = &batch->buckets[batch->bucket_count++];
+    bucket->font = font_data;
+    bucket->count = 0;
+    font_data->pending_batches++;
+    return bucket;
+}
+
+static int reserve_batch_glyphs(TextBatchBucket* bucket, int extra) {
+    if (bucket->count + extra <= bucket->capacity) return 1;
+    int capacity = bucket->capacity ? bucket->capacity : 256;
+    while (capacity < bucket->count + extra) capacity *= 2;
+    TextGlyphInstance* glyphs = (TextGlyphInstance*)realloc(bucket->glyphs, capacity * sizeof(TextGlyphInstance));
+    if (!glyphs) {
+        printf("Error: Failed to grow text batch\n");
+        return 0;
+    }
+    bucket->glyphs = glyphs;
+    bucket->capacity = capacity;
+    return 1;
+}
+
+static TextGlyphInstance make_glyph_instance(const FontData* font_data, const FontGlyph* glyph, const stbtt_aligned_quad* q, unsigned int color) {
+    TextGlyphInstance instance;
+    instance.x0 = q->x0;
+    instance.y0 = q->y0;
+    instance.x1 = q->x1;
+    instance.y1 = q->y1;
+    instance.s0 = (unsigned short)(glyph->x0 * 65535u / font_data->bitmap_w);
+    instance.t0 = (unsigned short)(glyph->y0 * 65535u / font_data->bitmap_h);
+    instance.s1 = (unsigned short)((glyph->x0 + glyph->w) * 65535u / font_data->bitmap_w);
+    instance.t1 = (unsigned short)((glyph->y0 + glyph->h) * 65535u / font_data->bitmap_h);
+    instance.color = color;
+    return instance;
+}
+
+// Point the instance attributes at a byte offset of the streaming buffer
+static void set_glyph_instance_attribs(GLintptr offset) {
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextGlyphInstance), (void*)(offset + offsetof(TextGlyphInstance, x0)));
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(TextGlyphInstance), (void*)(offset + offsetof(TextGlyphInstance, s0)));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TextGlyphInstance), (void*)(offset + offsetof(TextGlyphInstance, color)));
+}
+
+// Create the batch shader and streaming buffer
+int init_text_batch(TextBatch** batch) {
+    const char* vs_src =
+        "#version 330 core\n"
+        "layout(location = 0) in vec4 rect;\n"
+        "layout(location = 1) in vec4 uvRect;\n"
+        "layout(location = 2) in vec4 color;\n"
+        "uniform vec2 viewport;\n"
+        "uniform vec2 offset;\n"
+        "out vec2 TexCoord;\n"
+        "out vec4 Color;\n"
+        "void main() {\n"
+        "    // Triangle strip corners (0,0) (1,0) (0,1) (1,1)\n"
+        "    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n"
+        "    vec2 pixel = mix(rect.xy, rect.zw, corner) + offset;\n"
+        "    gl_Position = vec4(pixel.x / viewport.x * 2.0 - 1.0, 1.0 - pixel.y / viewport.y * 2.0, 0.0, 1.0);\n"
+        "    TexCoord = mix(uvRect.xy, uvRect.zw, corner);\n"
+        "    Color = color;\n"
+        "}\n";
+
+    const char* fs_src =
+        "#version 330 core\n"
+        "in vec2 TexCoord;\n"
+        "in vec4 Color;\n"
+        "out vec4 FragColor;\n"
+        "uniform sampler2D textTexture;\n"
+        "uniform int sdfMode;\n"
+        "void main() {\n"
+        "    float alpha = texture(textTexture, TexCoord).r;\n"
+        "    if (sdfMode != 0) {\n"
+        "        float edge = fwidth(alpha) * 0.7;\n"
+        "        alpha = smoothstep(0.5 - edge, 0.5 + edge, alpha);\n"
+        "    }\n"
+        "    FragColor = vec4(Color.rgb, alpha * Color.a);\n"
+        "}\n";
+
+    *batch = (struct TextBatch*)calloc(1, sizeof(struct TextBatch));
+    if (!*batch) {
+        printf("Error: Failed to allocate TextBatch\n");
+        return 0;
+    }
+
+    ShaderProgram* shader = create_shader_program(vs_src, fs_src, "Text batch");
+    if (!shader) {
+        free(*batch);
+        *batch = NULL;
+        return 0;
+    }
+
+    (*batch)->shader = shader;
+    (*batch)->texture_uniform = find_shader_uniform(shader, "textTexture");
+    (*batch)->sdf_uniform = find_shader_uniform(shader, "sdfMode");
+    (*batch)->viewport_uniform = find_shader_uniform(shader, "viewport");
+    (*batch)->offset_uniform = find_shader_uniform(shader, "offset");
+
+    glGenVertexArrays(1, &(*batch)->vao);
+    glGenBuffers(1, &(*batch)->vbo);
+    glstate_bind_vertex_array((*batch)->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, (*batch)->vbo);
+    for (GLuint i = 0; i < 3; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1); // Every attribute advances once per glyph
+    }
+    set_glyph_instance_attribs(0);
+    glstate_bind_vertex_array(0);
+
+    return 1;
+}
+
+// Drop the batch's hold on its fonts: their queued glyphs are drawn or discarded
+static void release_batch_buckets(TextBatch* batch) {
+    for (int i = 0; i < batch->bucket_count; i++) {
+        batch->buckets[i].font->pending_batches--;
+        release_pinned_glyphs(batch->buckets[i].font);
+    }
+    batch->bucket_count = 0;
+}
+
+// Start a new batch for a viewport of ww x hh pixels. Text still queued is discarded.
+void begin_text_batch(TextBatch* batch, int ww, int hh) {
+    if (!batch) return;
+    batch->ww = ww;
+    batch->hh = hh;
+    release_batch_buckets(batch);
+}
+
+// Lay out a string into the batch; nothing is drawn until flush_text_batch
+void queue_text(TextBatch* batch, FontData* font_data, const char* text, float x, float y, float r, float g, float b, float a) {
+    queue_text_sized(batch, font_data, text, x, y, 0.0f, r, g, b, a);
+}
+
+// Queue the bytes text..end with the pen starting at x, y
+static void queue_text_range(TextBatch* batch, FontData* font_data, const char* text, const char* end, float x, float y, float size, unsigned int color) {
+    float size_scale = get_size_scale(font_data, size);
+
+    TextBatchBucket* bucket = get_batch_bucket(batch, font_data);
+    if (!reserve_batch_glyphs(bucket, (int)(end - text))) return;
+
+    TextGlyphInstance* out = bucket->glyphs + bucket->count;
+
+    int prev_codepoint = -1, prev_glyph = 0;
+    for (const char* p = text; p < end && *p; ) {
+        int codepoint = decode_utf8(&p);
+        if (codepoint < 32) continue;
+        FontGlyph* glyph = get_glyph(font_data, codepoint);
+        if (!glyph) continue;
+        if (prev_codepoint >= 0) x += get_kerning(font_data, prev_codepoint, prev_glyph, codepoint, glyph->glyph_index) * size_scale;
+        prev_codepoint = codepoint;
+        prev_glyph = glyph->glyph_index;
+
+        stbtt_aligned_quad q;
+        get_glyph_quad(font_data, glyph, size_scale, &x, &y, &q);
+        if (glyph->w == 0 || glyph->h == 0) continue;
+
+        *out++ = make_glyph_instance(font_data, glyph, &q, color);
+    }
+    bucket->count = (int)(out - bucket->glyphs);
+}
+
+// Same as queue_text at a pixel size (0 = size the font was loaded at)
+void queue_text_sized(TextBatch* batch, FontData* font_data, const char* text, float x, float y, float size, float r, float g, float b, float a) {
+    if (!batch || !font_data || !text) return;
+    queue_text_range(batch, font_data, text, text + strlen(text), x, y, size, pack_color(r, g, b, a));
+}
+
+// Queue every line of a layout_text result; y is the baseline of the first line
+void queue_text_layout(TextBatch* batch, FontData* font_data, const TextLayout* layout, float size, float x, float y, float r, float g, float b, float a) {
+    if (!batch || !font_data || !layout) return;
+    unsigned int color = pack_color(r, g, b, a);
+    for (int i = 0; i < layout->line_count; i++) {
+        const char* start = layout->text + layout->lines[i].start;
+        queue_text_range(batch, font_data, start, start + layout->lines[i].length, x, y + i * layout->line_height, size, color);
+    }
+}
+
+// Upload every queued string in one buffer and draw each font atlas once
+void flush_text_batch(TextBatch* batch) {
+    if (!batch || batch->bucket_count == 0) return;
+
+    GLsizeiptr total = 0;
+    for (int i = 0; i < batch->bucket_count; i++) {
+        total += batch->buckets[i].count * (GLsizeiptr)sizeof(TextGlyphInstance);
+    }
+    if (total == 0) {
+        release_batch_buckets(batch);
+        return;
+    }
+
+    glstate_bind_vertex_array(batch->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, batch->vbo);
+
+    // Orphan the previous storage so the driver does not stall on last frame's draws
+    if (total > batch->vbo_size) {
+        batch->vbo_size = total * 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, batch->vbo_size, NULL, GL_STREAM_DRAW);
+
+    GLsizeiptr offset = 0;
+    for (int i = 0; i < batch->bucket_count; i++) {
+        GLsizeiptr size = batch->buckets[i].count * (GLsizeiptr)sizeof(TextGlyphInstance);
+        if (size) glBufferSubData(GL_ARRAY_BUFFER, offset, size, batch->buckets[i].glyphs);
+        offset += size;
+    }
+
+    glstate_use_program(batch->shader->id);
+    set_uniform_int(batch->shader, batch->texture_uniform, 0);
+    set_uniform_vec2(batch->shader, batch->viewport_uniform, (float)batch->ww, (float)batch->hh);
+    set_uniform_vec2(batch->shader, batch->offset_uniform, 0.0f, 0.0f);
+    glstate_active_texture(GL_TEXTURE0);
+
+    // GL 3.3 has no base instance, so each atlas re-points the attributes at its range
+    GLintptr first = 0;
+    for (int i = 0; i < batch->bucket_count; i++) {
+        TextBatchBucket* bucket = &batch->buckets[i];
+        if (bucket->count == 0) continue;
+        upload_font_atlas(bucket->font);
+        glstate_bind_texture(GL_TEXTURE_2D, bucket->font->texture);
+        set_uniform_int(batch->shader, batch->sdf_uniform, bucket->font->sdf);
+        set_glyph_instance_attribs(first);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, bucket->count);
+        first += bucket->count * (GLintptr)sizeof(TextGlyphInstance);
+    }
+
+    release_batch_buckets(batch); // Queued glyphs are drawn, they may be evicted again
+}
+
+static void draw_queued_text_batch(const RenderItem* item) {
+    flush_text_batch((TextBatch*)item->data);
+}
+
+void submit_text_batch(RenderQueue* queue, TextBatch* batch) {
+    if (!batch || batch->bucket_count == 0) return;
+    RenderItem* item = push_render_item(queue, make_render_key(RENDER_LAYER_UI, true, batch->shader->id, 0, batch->vao, 0.0f));
+    if (!item) {
+        flush_text_batch(batch); // Draw now rather than drop the text
+        return;
+    }
+    item->transparent = true;
+    item->draw = draw_queued_text_batch;
+    item->data = batch;
+}
+
+void cleanup_text_batch(TextBatch* batch) {
+    if (!batch) return;
+    release_batch_buckets(batch); // Unflushed text must not keep its fonts' glyphs pinned
+    for (int i = 0; i < TEXT_BATCH_MAX_FONTS; i++) {
+        free(batch->buckets[i].glyphs);
+    }
+    release_shader_program(batch->shader->id);
+    glDeleteBuffers(1, &batch->vbo);
+    glstate_delete_vertex_array(&batch->vao);
+    free(batch);
+}
+
+// Retained text: glyph instances laid out once at the origin and kept in a GPU
+// buffer; drawing only sets the offset uniform
+struct TextObject {
+    FontData* font;
+    char* text;
+    float size;                   // Pixel size (0 = size the font was loaded at)
+    unsigned int color;           // Packed RGBA8
+    GLuint vao, vbo;
+    GLsizeiptr vbo_size;          // Buffer size in bytes
+    int glyph_count;              // Instances in the buffer
+    int* glyph_indices;           // font->glyphs index of each instance, stamped on every draw (LRU)
+    int glyph_capacity;
+    unsigned int atlas_epoch;     // font->atlas_epoch when the buffer was built
+    int dirty;                    // Text, size, color or font changed since the last build
+};
+
+static int set_text_object_string(TextObject* text_object, const char* text) {
+    size_t len = strlen(text);
+    char* copy = (char*)malloc(len + 1);
+    if (!copy) {
+        printf("Error: Failed to allocate text object string\n");
+        return 0;
+    }
+    memcpy(copy, text, len + 1);
+    free(text_object->text);
+    text_object->text = copy;
+    return 1;
+}
+
+// Lay the string out at the origin and upload the instances
+static int build_text_object(TextObject* text_object) {
+    FontData* font_data = text_object->font;
+    int max_glyphs = (int)strlen(text_object->text);
+    TextGlyphInstance* instances = NULL;
+    if (max_glyphs > 0) {
+        instances = (TextGlyphInstance*)malloc(max_glyphs * sizeof(TextGlyphInstance));
+        if (!instances) {
+            printf("Error: Failed to allocate text object glyphs\n");
+            return 0;
+        }
+    }
+    if (max_glyphs > text_object->glyph_capacity) {
+        int* indices = (int*)realloc(text_object->glyph_indices, max_glyphs * sizeof(int));
+        if (!indices) {
+            printf("Error: Failed to allocate text object glyphs\n");
+            free(instances);
+            return 0;
+        }
+        text_object->glyph_indices = indices;
+        text_object->glyph_capacity = max_glyphs;
+    }
+
+    float size_scale = get_size_scale(font_data, text_object->size);
+    float x = 0.0f, y = 0.0f;
+    int count = 0;
+    int prev_codepoint = -1, prev_glyph = 0;
+    for (const char* p = text_object->text; *p; ) {
+        int codepoint = decode_utf8(&p);
+        if (codepoint < 32) continue;
+        FontGlyph* glyph = get_glyph(font_data, codepoint);
+        if (!glyph) continue;
+        if (prev_codepoint >= 0) x += get_kerning(font_data, prev_codepoint, prev_glyph, codepoint, glyph->glyph_index) * size_scale;
+        prev_codepoint = codepoint;
+        prev_glyph = glyph->glyph_index;
+
+        stbtt_aligned_quad q;
+        get_glyph_quad(font_data, glyph, size_scale, &x, &y, &q);
+        if (glyph->w == 0 || glyph->h == 0) continue;
+
+        // An index, not the pointer: get_glyph may grow the glyph array
+        text_object->glyph_indices[count] = (int)(glyph - font_data->glyphs);
+        instances[count++] = make_glyph_instance(font_data, glyph, &q, text_object->color);
+    }
+
+    GLsizeiptr size = count * (GLsizeiptr)sizeof(TextGlyphInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, text_object->vbo);
+    if (size > text_object->vbo_size) {
+        glBufferData(GL_ARRAY_BUFFER, size, instances, GL_STATIC_DRAW);
+        text_object->vbo_size = size;
+    } else if (size) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances);
+    }
+    free(instances);
+
+    text_object->glyph_count = count;
+    // Glyphs placed above were pinned, so any eviction during layout left them resident
+    text_object->atlas_epoch = font_data->atlas_epoch;
+    text_object->dirty = 0;
+    return 1;
+}
+
+// Create a retained string; the buffer is built on the first draw
+int create_text_object(FontData* font_data, const char* text, float size, float r, float g, float b, float a, TextObject** text_object) {
+    if (!font_data || !text) return 0;
+
+    *text_object = (struct TextObject*)calloc(1, sizeof(struct TextObject));
+    if (!*text_object) {
+        printf("Error: Failed to allocate TextObject\n");
+        return 0;
+    }
+    if (!set_text_object_string(*text_object, text)) {
+        free(*text_object);
+        *text_object = NULL;
+        return 0;
+    }
+    (*text_object)->font = font_data;
+    (*text_object)->size = size;
+    (*text_object)->color = pack_color(r, g, b, a);
+    (*text_object)->dirty = 1;
+
+    glGenVertexArrays(1, &(*text_object)->vao);
+    glGenBuffers(1, &(*text_object)->vbo);
+    glstate_bind_vertex_array((*text_object)->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, (*text_object)->vbo);
+    for (GLuint i = 0; i < 3; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+    set_glyph_instance_attribs(0);
+    glstate_bind_vertex_array(0);
+
+    return 1;
+}
+
+// Change what a retained string shows; does nothing if all values are the same
+int update_text_object(TextObject* text_object, FontData* font_data, const char* text, float size, float r, float g, float b, float a) {
+    if (!text_object || !font_data || !text) return 0;
+
+    unsigned int color = pack_color(r, g, b, a);
+    if (text_object->font == font_data && text_object->size == size &&
+        text_object->color == color && strcmp(text_object->text, text) == 0) {
+        return 1;
+    }
+    if (strcmp(text_object->text, text) != 0 && !set_text_object_string(text_object, text)) return 0;
+
+    text_object->font = font_data;
+    text_object->size = size;
+    text_object->color = color;
+    text_object->dirty = 1;
+    return 1;
+}
+
+// Draw a retained string at x, y with the batch shader and the viewport given to
+// begin_text_batch. Draws right away, it is not queued with the batch.
+void draw_text_object(TextBatch* batch, TextObject* text_object, float x, float y) {
+    if (!batch || !text_object) return;
+
+    FontData* font_data = text_object->font;
+    // An eviction may have moved glyphs this buffer points at
+    if (text_object->dirty || text_object->atlas_epoch != font_data->atlas_epoch) {
+        if (!build_text_object(text_object)) return;
+    }
+    if (text_object->glyph_count == 0) {
+        release_pinned_glyphs(font_data);
+        return;
+    }
+
+    // Drawn this frame, so the LRU keeps them like any queued text
+    for (int i = 0; i < text_object->glyph_count; i++) {
+        font_data->glyphs[text_object->glyph_indices[i]].last_used = font_data->draw_serial;
+    }
+
+    upload_font_atlas(font_data);
+
+    glstate_use_program(batch->shader->id);
+    set_uniform_int(batch->shader, batch->texture_uniform, 0);
+    set_uniform_int(batch->shader, batch->sdf_uniform, font_data->sdf);
+    set_uniform_vec2(batch->shader, batch->viewport_uniform, (float)batch->ww, (float)batch->hh);
+    set_uniform_vec2(batch->shader, batch->offset_uniform, x, y);
+    glstate_active_texture(GL_TEXTURE0);
+    glstate_bind_texture(GL_TEXTURE_2D, font_data->texture);
+
+    glstate_bind_vertex_array(text_object->vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, text_object->glyph_count);
+    release_pinned_glyphs(font_data);
+}
+
+void cleanup_text_object(TextObject* text_object) {
+    if (!text_object) return;
+    glDeleteBuffers(1, &text_object->vbo);
+    glstate_delete_vertex_array(&text_object->vao);
+    free(text_object->glyph_indices);
+    free(text_object->text);
+    free(text_object);
 }
 
 // Clean up font resources
 void cleanup_font(FontData* font_data) {
     if (!font_data) return;
-    glDeleteTextures(1, &font_data->texture);
-    free(font_data->cdata);
+    if (font_data->texture) glstate_delete_texture(&font_data->texture);
+    free(font_data->glyph_map);
+    free(font_data->glyphs);
+    free(font_data->kern_ascii);
+    free(font_data->kern_pairs);
+    free_text_layouts(font_data);
+    free(font_data->skyline);
+    free(font_data->bitmap);
+    release_font_source(font_data->source);
     free(font_data);
+    if (!font_sources) {
+        // Last font is gone
+        cleanup_frame_arena(text_arena);
+        text_arena = NULL;
+    }
 }
 
 // Alternative functions using a static FontData
@@ -168,61 +1743,29 @@ int init_font_shaders_and_buffers(GLuint* program, GLuint* vao, GLuint* vbo) {
         "out vec4 FragColor;\n"
         "uniform sampler2D textTexture;\n"
         "uniform vec4 textColor;\n"
+        "uniform int sdfMode;\n"
         "void main() {\n"
         "    float alpha = texture(textTexture, TexCoord).r;\n"
+        "    if (sdfMode != 0) {\n"
+        "        // Distance field: 0.5 is the outline, fwidth keeps the edge one pixel wide at any scale\n"
+        "        float edge = fwidth(alpha) * 0.7;\n"
+        "        alpha = smoothstep(0.5 - edge, 0.5 + edge, alpha);\n"
+        "    }\n"
         "    FragColor = vec4(textColor.rgb, alpha * textColor.a);\n"
         "}\n";
 
-    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vs, 1, &vs_src, NULL);
-    glCompileShader(vs);
-    GLint success;
-    glGetShaderiv(vs, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetShaderInfoLog(vs, 512, NULL, info_log);
-        printf("Vertex shader compilation failed: %s\n", info_log);
-        return 0;
-    }
-
-    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fs, 1, &fs_src, NULL);
-    glCompileShader(fs);
-    glGetShaderiv(fs, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetShaderInfoLog(fs, 512, NULL, info_log);
-        printf("Fragment shader compilation failed: %s\n", info_log);
-        glDeleteShader(vs);
-        return 0;
-    }
-
-    *program = glCreateProgram();
-    glAttachShader(*program, vs);
-    glAttachShader(*program, fs);
-    glLinkProgram(*program);
-    glGetProgramiv(*program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char info_log[512];
-        glGetProgramInfoLog(*program, 512, NULL, info_log);
-        printf("Program linking failed: %s\n", info_log);
-        glDeleteShader(vs);
-        glDeleteShader(fs);
-        return 0;
-    }
-
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    *program = compile_shader_program(vs_src, fs_src, "Text");
+    if (!*program) return 0;
 
     glGenVertexArrays(1, vao);
     glGenBuffers(1, vbo);
-    glBindVertexArray(*vao);
+    glstate_bind_vertex_array(*vao);
     glBindBuffer(GL_ARRAY_BUFFER, *vbo);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glBindVertexArray(0);
+    glstate_bind_vertex_array(0);
 
     return 1;
 }
@@ -0,0 +1,166 @@
+// module_glstate.c
+#include <stdbool.h>
+#include "module_glstate.h"
+
+#define GLSTATE_UNKNOWN 0xFFFFFFFFu
+
+// Capabilities that are shadowed; others pass straight through
+static const GLenum tracked_caps[] = { GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_SCISSOR_TEST };
+#define GLSTATE_CAP_COUNT (sizeof(tracked_caps) / sizeof(tracked_caps[0]))
+
+static struct {
+    GLuint program;
+    GLuint vao;
+    GLenum active_unit;                        // Index, not GL_TEXTURE0 + n
+    GLuint texture_2d[GLSTATE_TEXTURE_UNITS];
+    int caps[GLSTATE_CAP_COUNT];               // -1 unknown, 0 off, 1 on
+    GLenum blend_src, blend_dst;
+    int depth_mask;                            // -1 unknown
+    GLStateStats frame, last_frame;
+    bool valid;                                // false until the first call marks everything unknown
+} glstate;
+
+static const char* call_names[GLSTATE_CALL_COUNT] = {
+    "glUseProgram", "glBindVertexArray", "glActiveTexture", "glBindTexture", "glEnable/glDisable", "glBlendFunc", "glDepthMask"
+};
+
+// A zeroed shadow would read as "bound to 0, everything off", which GL's defaults
+// are not (depth writes start on), so the first call makes it unknown instead
+static void ensure_valid(void) {
+    if (!glstate.valid) glstate_invalidate();
+}
+
+// Count the call; returns 1 when it has to reach the driver
+static int track(GLStateCall call, int changed) {
+    if (changed) {
+        glstate.frame.issued[call]++;
+        glstate.frame.total_issued++;
+    } else {
+        glstate.frame.elided[call]++;
+        glstate.frame.total_elided++;
+    }
+    return changed;
+}
+
+void glstate_use_program(GLuint program) {
+    ensure_valid();
+    if (!track(GLSTATE_PROGRAM, glstate.program != program)) return;
+    glstate.program = program;
+    glUseProgram(program);
+}
+
+void glstate_bind_vertex_array(GLuint vao) {
+    ensure_valid();
+    if (!track(GLSTATE_VERTEX_ARRAY, glstate.vao != vao)) return;
+    glstate.vao = vao;
+    glBindVertexArray(vao);
+}
+
+void glstate_active_texture(GLenum unit) {
+    ensure_valid();
+    GLenum index = unit - GL_TEXTURE0;
+    if (!track(GLSTATE_ACTIVE_TEXTURE, glstate.active_unit != index)) return;
+    glstate.active_unit = index;
+    glActiveTexture(unit);
+}
+
+void glstate_bind_texture(GLenum target, GLuint texture) {
+    ensure_valid();
+    GLenum unit = glstate.active_unit;
+    if (target != GL_TEXTURE_2D || unit >= GLSTATE_TEXTURE_UNITS) {
+        // Untracked target, or the active unit is unknown
+        track(GLSTATE_TEXTURE, 1);
+        glBindTexture(target, texture);
+        return;
+    }
+    if (!track(GLSTATE_TEXTURE, glstate.texture_2d[unit] != texture)) return;
+    glstate.texture_2d[unit] = texture;
+    glBindTexture(target, texture);
+}
+
+static int find_cap(GLenum cap) {
+    for (int i = 0; i < (int)GLSTATE_CAP_COUNT; i++) {
+        if (tracked_caps[i] == cap) return i;
+    }
+    return -1;
+}
+
+static void set_cap(GLenum cap, int on) {
+    ensure_valid();
+    int i = find_cap(cap);
+    if (i >= 0) {
+        if (!track(GLSTATE_CAPABILITY, glstate.caps[i] != on)) return;
+        glstate.caps[i] = on;
+    } else {
+        track(GLSTATE_CAPABILITY, 1);
+    }
+    if (on) glEnable(cap);
+    else glDisable(cap);
+}
+
+void glstate_enable(GLenum cap) {
+    set_cap(cap, 1);
+}
+
+void glstate_disable(GLenum cap) {
+    set_cap(cap, 0);
+}
+
+void glstate_blend_func(GLenum src, GLenum dst) {
+    ensure_valid();
+    if (!track(GLSTATE_BLEND_FUNC, glstate.blend_src != src || glstate.blend_dst != dst)) return;
+    glstate.blend_src = src;
+    glstate.blend_dst = dst;
+    glBlendFunc(src, dst);
+}
+
+void glstate_depth_mask(GLboolean write) {
+    ensure_valid();
+    int on = write ? 1 : 0;
+    if (!track(GLSTATE_DEPTH_MASK, glstate.depth_mask != on)) return;
+    glstate.depth_mask = on;
+    glDepthMask(write);
+}
+
+void glstate_delete_texture(GLuint* texture) {
+    if (!*texture) return;
+    // Deleting a bound texture rebinds 0 on that unit
+    for (int i = 0; i < GLSTATE_TEXTURE_UNITS; i++) {
+        if (glstate.texture_2d[i] == *texture) glstate.texture_2d[i] = 0;
+    }
+    glDeleteTextures(1, texture);
+    *texture = 0;
+}
+
+void glstate_delete_vertex_array(GLuint* vao) {
+    if (!*vao) return;
+    if (glstate.vao == *vao) glstate.vao = 0;
+    glDeleteVertexArrays(1, vao);
+    *vao = 0;
+}
+
+void glstate_invalidate(void) {
+    glstate.program = GLSTATE_UNKNOWN;
+    glstate.vao = GLSTATE_UNKNOWN;
+    glstate.active_unit = GLSTATE_UNKNOWN;
+    for (int i = 0; i < GLSTATE_TEXTURE_UNITS; i++) glstate.texture_2d[i] = GLSTATE_UNKNOWN;
+    for (int i = 0; i < (int)GLSTATE_CAP_COUNT; i++) glstate.caps[i] = -1;
+    glstate.blend_src = GLSTATE_UNKNOWN;
+    glstate.blend_dst = GLSTATE_UNKNOWN;
+    glstate.depth_mask = -1;
+    glstate.valid = true;
+}
+
+void glstate_begin_frame(void) {
+    glstate.last_frame = glstate.frame;
+    glstate.frame = (GLStateStats){0};
+}
+
+const GLStateStats* glstate_get_stats(void) {
+    return &glstate.last_frame;
+}
+
+const char* glstate_call_name(GLStateCall call) {
+    if (call < 0 || call >= GLSTATE_CALL_COUNT) return "unknown";
+    return call_names[call];
+}
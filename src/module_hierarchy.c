@@ -0,0 +1,345 @@
+// module_hierarchy.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "module_hierarchy.h"
+#include "module_transform3d.h"
+
+// An in-place change shifts every node after it, so bulk spawns and deletes would go
+// quadratic: past these limits the change is left to one full rebuild instead
+#define HIERARCHY_SPLICE_TAIL 1024      // Max nodes behind the change
+#define HIERARCHY_SPLICE_CHANGES 64     // Max in-place changes between two updates
+
+static unsigned int hash_entity(ecs_entity_t entity) {
+    return (unsigned int)((entity * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+int find_hierarchy_node(const HierarchyCache* cache, ecs_entity_t entity) {
+    if (!cache || !cache->map_capacity || !entity) return -1;
+    unsigned int mask = cache->map_capacity - 1;
+    unsigned int slot = hash_entity(entity) & mask;
+    while (cache->map[slot].entity) {
+        if (cache->map[slot].entity == entity) return cache->map[slot].index;
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+// Insert or overwrite; the map must have a free slot
+static void set_hierarchy_slot(HierarchyCache* cache, ecs_entity_t entity, int index) {
+    unsigned int mask = cache->map_capacity - 1;
+    unsigned int slot = hash_entity(entity) & mask;
+    while (cache->map[slot].entity && cache->map[slot].entity != entity) slot = (slot + 1) & mask;
+    cache->map[slot].entity = entity;
+    cache->map[slot].index = index;
+}
+
+// Linear probing delete: pull later entries of the run back so lookups never stop early
+static void remove_hierarchy_slot(HierarchyCache* cache, ecs_entity_t entity) {
+    unsigned int mask = cache->map_capacity - 1;
+    unsigned int slot = hash_entity(entity) & mask;
+    while (cache->map[slot].entity != entity) {
+        if (!cache->map[slot].entity) return;
+        slot = (slot + 1) & mask;
+    }
+    unsigned int hole = slot;
+    for (;;) {
+        slot = (slot + 1) & mask;
+        if (!cache->map[slot].entity) break;
+        unsigned int home = hash_entity(cache->map[slot].entity) & mask;
+        // Move it into the hole unless its home lies cyclically in (hole, slot]
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            cache->map[hole] = cache->map[slot];
+            hole = slot;
+        }
+    }
+    cache->map[hole].entity = 0;
+}
+
+// Room for count entities at a load of at most one half
+static int reserve_hierarchy_map(HierarchyCache* cache, int count) {
+    if (count * 2 <= cache->map_capacity) return 1;
+    int capacity = cache->map_capacity ? cache->map_capacity : 64;
+    while (capacity < count * 2) capacity *= 2;
+    HierarchySlot* map = (HierarchySlot*)calloc(capacity, sizeof(HierarchySlot));
+    if (!map) {
+        printf("Error: Out of memory growing hierarchy map\n");
+        return 0;
+    }
+    free(cache->map);
+    cache->map = map;
+    cache->map_capacity = capacity;
+    for (int i = 0; i < cache->count; i++) set_hierarchy_slot(cache, cache->nodes[i].entity, i);
+    return 1;
+}
+
+static int reserve_hierarchy_nodes(HierarchyCache* cache, int count) {
+    if (count <= cache->capacity) return 1;
+    int capacity = cache->capacity ? cache->capacity : 64;
+    while (capacity < count) capacity *= 2;
+    HierarchyNode* nodes = (HierarchyNode*)realloc(cache->nodes, capacity * sizeof(HierarchyNode));
+    if (!nodes) {
+        printf("Error: Out of memory growing hierarchy cache\n");
+        return 0;
+    }
+    cache->nodes = nodes;
+    cache->capacity = capacity;
+    return 1;
+}
+
+// Point the map at the nodes in [begin, end) after they moved
+static void reindex_hierarchy_nodes(HierarchyCache* cache, int begin, int end) {
+    for (int i = begin; i < end; i++) set_hierarchy_slot(cache, cache->nodes[i].entity, i);
+}
+
+// Where a block for parent would go, in current indices
+static int find_run_end(const HierarchyCache* cache, int parent) {
+    return parent < 0 ? cache->count : parent + cache->nodes[parent].subtree;
+}
+
+static void add_to_ancestors(HierarchyCache* cache, int parent, int amount) {
+    for (int p = parent; p >= 0; p = cache->nodes[p].parent) cache->nodes[p].subtree += amount;
+}
+
+// Cut nodes [index, index + n) out into block; block parents become relative to the block
+static void extract_hierarchy_block(HierarchyCache* cache, int index, int n, HierarchyNode* block) {
+    memcpy(block, &cache->nodes[index], n * sizeof(HierarchyNode));
+    for (int k = 1; k < n; k++) block[k].parent -= index;
+    add_to_ancestors(cache, cache->nodes[index].parent, -n);
+
+    memmove(&cache->nodes[index], &cache->nodes[index + n], (cache->count - index - n) * sizeof(HierarchyNode));
+    cache->count -= n;
+    // Parents come first, so only nodes behind the gap can point past it
+    for (int i = index; i < cache->count; i++) {
+        if (cache->nodes[i].parent >= index + n) cache->nodes[i].parent -= n;
+    }
+}
+
+// Place a block at the end of parent's run (the end of the array for roots); returns its index.
+// The nodes array must have room.
+static int insert_hierarchy_block(HierarchyCache* cache, int parent, const HierarchyNode* block, int n) {
+    int at = find_run_end(cache, parent);
+    memmove(&cache->nodes[at + n], &cache->nodes[at], (cache->count - at) * sizeof(HierarchyNode));
+    cache->count += n;
+    for (int i = at + n; i < cache->count; i++) {
+        if (cache->nodes[i].parent >= at) cache->nodes[i].parent += n;
+    }
+
+    int depth = parent < 0 ? 0 : cache->nodes[parent].depth + 1;
+    int shift = depth - block[0].depth;
+    for (int k = 0; k < n; k++) {
+        HierarchyNode node = block[k];
+        node.parent = k == 0 ? parent : node.parent + at;
+        node.depth += shift;
+        cache->nodes[at + k] = node;
+    }
+    add_to_ancestors(cache, parent, n);
+    return at;
+}
+
+// Nearest ancestor with a node, -1 if there is none
+static int find_transform_parent(const HierarchyCache* cache, ecs_entity_t entity) {
+    ecs_entity_t parent = ecs_get_target(cache->world, entity, EcsChildOf, 0);
+    while (parent) {
+        int index = find_hierarchy_node(cache, parent);
+        if (index >= 0) return index;
+        parent = ecs_get_target(cache->world, parent, EcsChildOf, 0);
+    }
+    return -1;
+}
+
+// Whether a change that shifts every node from first on is cheap enough to do in place;
+// if not, the cache is marked for a rebuild
+static bool can_splice(HierarchyCache* cache, int first) {
+    if (++cache->splices > HIERARCHY_SPLICE_CHANGES || cache->count - first > HIERARCHY_SPLICE_TAIL) {
+        cache->stale = true;
+        return false;
+    }
+    return true;
+}
+
+// New entity without transform descendants: one node at the end of its parent's run
+static void insert_hierarchy_leaf(HierarchyCache* cache, ecs_entity_t entity) {
+    int parent = find_transform_parent(cache, entity);
+    if (!can_splice(cache, find_run_end(cache, parent))) return;
+    if (!reserve_hierarchy_nodes(cache, cache->count + 1) || !reserve_hierarchy_map(cache, cache->count + 1)) {
+        cache->stale = true;
+        return;
+    }
+    HierarchyNode node = { entity, -1, 0, 1 };
+    int at = insert_hierarchy_block(cache, parent, &node, 1);
+    reindex_hierarchy_nodes(cache, at, cache->count);
+}
+
+// Drop one node; its children move up to its parent and keep their place in the run
+static void remove_hierarchy_node(HierarchyCache* cache, int index) {
+    if (!can_splice(cache, index)) return;
+    HierarchyNode removed = cache->nodes[index];
+    add_to_ancestors(cache, removed.parent, -1);
+    for (int k = index + 1; k < index + removed.subtree; k++) {
+        cache->nodes[k].depth--;
+        if (cache->nodes[k].parent == index) cache->nodes[k].parent = removed.parent;
+    }
+    remove_hierarchy_slot(cache, removed.entity);
+
+    memmove(&cache->nodes[index], &cache->nodes[index + 1], (cache->count - index - 1) * sizeof(HierarchyNode));
+    cache->count--;
+    for (int i = index; i < cache->count; i++) {
+        if (cache->nodes[i].parent > index) cache->nodes[i].parent--;
+    }
+    reindex_hierarchy_nodes(cache, index, cache->count);
+}
+
+// Reparent: the subtree at index moves as one block to the end of parent's run.
+// parent is in current indices (-1 makes it a root) and is never inside the subtree.
+static void move_hierarchy_subtree(HierarchyCache* cache, int index, int parent) {
+    int dest = find_run_end(cache, parent);
+    if (!can_splice(cache, index < dest ? index : dest)) return;
+    int n = cache->nodes[index].subtree;
+    HierarchyNode* block = (HierarchyNode*)malloc(n * sizeof(HierarchyNode));
+    if (!block) {
+        printf("Error: Out of memory moving hierarchy subtree\n");
+        cache->stale = true;
+        return;
+    }
+    extract_hierarchy_block(cache, index, n, block);
+    if (parent >= index + n) parent -= n;
+    int at = insert_hierarchy_block(cache, parent, block, n);
+    free(block);
+
+    // Only the nodes between the old and the new place changed index
+    int begin = index < at ? index : at;
+    int end = (index > at ? index : at) + n;
+    reindex_hierarchy_nodes(cache, begin, end);
+}
+
+// Whether transform descendants could hang off an entity the cache does not track
+static bool has_children(ecs_world_t* world, ecs_entity_t entity) {
+    ecs_iter_t it = ecs_children(world, entity);
+    while (ecs_children_next(&it)) {
+        if (it.count > 0) {
+            ecs_iter_fini(&it);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void on_world_matrix_changed(ecs_iter_t* it) {
+    if (ecs_is_fini(it->world)) return; // The cache may already be freed
+    HierarchyCache* cache = (HierarchyCache*)it->ctx;
+    for (int i = 0; i < it->count && !cache->stale; i++) {
+        ecs_entity_t entity = it->entities[i];
+        int index = find_hierarchy_node(cache, entity);
+        if (it->event == EcsOnAdd) {
+            if (index >= 0) continue;
+            // Its transform descendants would have to be found and moved under it
+            if (has_children(it->world, entity)) cache->stale = true;
+            else insert_hierarchy_leaf(cache, entity);
+        } else if (index >= 0) {
+            remove_hierarchy_node(cache, index);
+        }
+    }
+    cache->version++;
+}
+
+// Flecs sends OnRemove for the old ChildOf pair before OnAdd for the new one, so a
+// reparent is a move to the roots followed by a move under the new parent.
+static void on_child_of_changed(ecs_iter_t* it) {
+    if (ecs_is_fini(it->world)) return;
+    HierarchyCache* cache = (HierarchyCache*)it->ctx;
+    for (int i = 0; i < it->count && !cache->stale; i++) {
+        ecs_entity_t entity = it->entities[i];
+        int index = find_hierarchy_node(cache, entity);
+        if (index < 0) {
+            // Not a transform itself, but it may carry transform descendants along
+            if (has_children(it->world, entity)) cache->stale = true;
+            continue;
+        }
+        int parent = it->event == EcsOnAdd ? find_transform_parent(cache, entity) : -1;
+        if (parent != cache->nodes[index].parent) move_hierarchy_subtree(cache, index, parent);
+    }
+    cache->version++;
+}
+
+static void free_hierarchy_cache(ecs_world_t* world, void* ctx) {
+    (void)world;
+    HierarchyCache* cache = (HierarchyCache*)ctx;
+    free(cache->nodes);
+    free(cache->map);
+    free(cache);
+}
+
+HierarchyCache* create_hierarchy_cache(ecs_world_t* world) {
+    HierarchyCache* cache = (HierarchyCache*)calloc(1, sizeof(HierarchyCache));
+    if (!cache) {
+        printf("Error: Out of memory creating hierarchy cache\n");
+        return NULL;
+    }
+    cache->world = world;
+    cache->stale = true; // Entities may exist already: the first update builds it
+    cache->roots = ecs_query(world, {
+        .terms = {
+            { .id = ecs_id(WorldMatrix) },
+            { .id = ecs_id(WorldMatrix), .src.id = EcsUp, .trav = EcsChildOf, .oper = EcsNot }
+        }
+    });
+
+    // Reparenting, spawning and deleting all add or remove one of these
+    ecs_observer(world, {
+        .query.terms = {{ .id = ecs_pair(EcsChildOf, EcsWildcard) }},
+        .events = { EcsOnAdd, EcsOnRemove },
+        .callback = on_child_of_changed,
+        .ctx = cache
+    });
+    ecs_observer(world, {
+        .query.terms = {{ .id = ecs_id(WorldMatrix) }},
+        .events = { EcsOnAdd, EcsOnRemove },
+        .callback = on_world_matrix_changed,
+        .ctx = cache
+    });
+
+    ecs_atfini(world, free_hierarchy_cache, cache);
+    return cache;
+}
+
+// Children without WorldMatrix are walked through: their transform descendants hang
+// off the nearest transform ancestor, the same one update_transform_system uses.
+static void add_hierarchy_subtree(HierarchyCache* cache, ecs_entity_t entity, int parent, int depth) {
+    int index = -1;
+    if (ecs_has(cache->world, entity, WorldMatrix)) {
+        if (!reserve_hierarchy_nodes(cache, cache->count + 1)) return;
+        index = cache->count++;
+        cache->nodes[index] = (HierarchyNode){ entity, parent, depth, 1 };
+        parent = index;
+        depth++;
+    }
+
+    ecs_iter_t it = ecs_children(cache->world, entity);
+    while (ecs_children_next(&it)) {
+        for (int i = 0; i < it.count; i++) add_hierarchy_subtree(cache, it.entities[i], parent, depth);
+    }
+    if (index >= 0) cache->nodes[index].subtree = cache->count - index;
+}
+
+bool update_hierarchy_cache(HierarchyCache* cache) {
+    if (!cache) return false;
+    cache->splices = 0;
+    if (!cache->stale) return false;
+
+    cache->count = 0;
+    ecs_iter_t it = ecs_query_iter(cache->world, cache->roots);
+    while (ecs_query_next(&it)) {
+        for (int i = 0; i < it.count; i++) add_hierarchy_subtree(cache, it.entities[i], -1, 0);
+    }
+
+    if (cache->map) memset(cache->map, 0, cache->map_capacity * sizeof(HierarchySlot));
+    if (!reserve_hierarchy_map(cache, cache->count)) return false;
+    reindex_hierarchy_nodes(cache, 0, cache->count);
+
+    cache->stale = false;
+    cache->version++;
+    return true;
+}
@@ -0,0 +1,136 @@
+// module_jobs.c
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <SDL3/SDL.h>
+
+#include "module_jobs.h"
+
+#define JOB_MAX_WORKERS 64
+
+static struct {
+    bool running;
+    bool quit;
+    SDL_Thread* workers[JOB_MAX_WORKERS];
+    int worker_count;
+    SDL_Mutex* mutex;           // Guards everything below but next
+    SDL_Condition* wake;        // Signalled when a batch starts or on quit
+    SDL_Condition* done;        // Signalled when the last worker leaves a batch
+    // Current batch
+    JobFunction fn;
+    void* ctx;
+    int count;
+    int generation;             // Bumped per batch, workers run each one once
+    int busy;                   // Workers not yet finished with the batch
+    SDL_AtomicInt next;         // Next index to claim
+} pool;
+
+// Claim indices until the batch runs out
+static void drain_jobs(JobFunction fn, void* ctx, int count) {
+    for (;;) {
+        int index = SDL_AddAtomicInt(&pool.next, 1);
+        if (index >= count) return;
+        fn(ctx, index);
+    }
+}
+
+static int job_worker(void* data) {
+    (void)data;
+    int seen = 0;
+    SDL_LockMutex(pool.mutex);
+    for (;;) {
+        while (!pool.quit && pool.generation == seen) SDL_WaitCondition(pool.wake, pool.mutex);
+        if (pool.quit) {
+            SDL_UnlockMutex(pool.mutex);
+            return 0;
+        }
+        seen = pool.generation;
+        JobFunction fn = pool.fn;
+        void* ctx = pool.ctx;
+        int count = pool.count;
+        SDL_UnlockMutex(pool.mutex);
+
+        drain_jobs(fn, ctx, count);
+
+        SDL_LockMutex(pool.mutex);
+        if (--pool.busy == 0) SDL_SignalCondition(pool.done);
+    }
+}
+
+int init_job_pool(int worker_count) {
+    if (pool.running) return 1;
+    memset(&pool, 0, sizeof(pool));
+
+    if (worker_count <= 0) worker_count = SDL_GetNumLogicalCPUCores() - 1;
+    if (worker_count < 1) worker_count = 1;
+    if (worker_count > JOB_MAX_WORKERS) worker_count = JOB_MAX_WORKERS;
+
+    pool.mutex = SDL_CreateMutex();
+    pool.wake = SDL_CreateCondition();
+    pool.done = SDL_CreateCondition();
+    if (!pool.mutex || !pool.wake || !pool.done) {
+        printf("Error: Failed to create job pool lock: %s\n", SDL_GetError());
+        SDL_DestroyMutex(pool.mutex);
+        SDL_DestroyCondition(pool.wake);
+        SDL_DestroyCondition(pool.done);
+        return 0;
+    }
+    for (int i = 0; i < worker_count; i++) {
+        pool.workers[i] = SDL_CreateThread(job_worker, "job_worker", NULL);
+        if (!pool.workers[i]) {
+            printf("Error: Failed to start job worker: %s\n", SDL_GetError());
+            break;
+        }
+        pool.worker_count++;
+    }
+    pool.running = true;
+    if (pool.worker_count == 0) {
+        cleanup_job_pool();
+        return 0;
+    }
+    return 1;
+}
+
+void cleanup_job_pool(void) {
+    if (!pool.running) return;
+
+    SDL_LockMutex(pool.mutex);
+    pool.quit = true;
+    SDL_BroadcastCondition(pool.wake);
+    SDL_UnlockMutex(pool.mutex);
+    for (int i = 0; i < pool.worker_count; i++) SDL_WaitThread(pool.workers[i], NULL);
+
+    SDL_DestroyCondition(pool.wake);
+    SDL_DestroyCondition(pool.done);
+    SDL_DestroyMutex(pool.mutex);
+    memset(&pool, 0, sizeof(pool));
+}
+
+int get_job_worker_count(void) {
+    return pool.running ? pool.worker_count : 0;
+}
+
+void run_jobs(int count, JobFunction fn, void* ctx) {
+    if (count <= 0) return;
+    if (!pool.running || count == 1) {
+        for (int i = 0; i < count; i++) fn(ctx, i);
+        return;
+    }
+
+    SDL_LockMutex(pool.mutex);
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.count = count;
+    SDL_SetAtomicInt(&pool.next, 0);
+    pool.busy = pool.worker_count;
+    pool.generation++;
+    SDL_BroadcastCondition(pool.wake);
+    SDL_UnlockMutex(pool.mutex);
+
+    drain_jobs(fn, ctx, count);
+
+    // Barrier: every worker has left the batch, so all writes are visible here
+    SDL_LockMutex(pool.mutex);
+    while (pool.busy > 0) SDL_WaitCondition(pool.done, pool.mutex);
+    SDL_UnlockMutex(pool.mutex);
+}
@@ -0,0 +1,160 @@
+// module_mesh.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "module_mesh.h"
+#include "module_mmap.h"
+#include "module_glstate.h"
+
+// GL type, component count and normalized flag per MESH_FORMAT_*
+static const struct {
+    GLenum type;
+    GLint components;
+    GLboolean normalized;
+} mesh_gl_formats[MESH_FORMAT_COUNT] = {
+    [MESH_FORMAT_FLOAT2] = { GL_FLOAT, 2, GL_FALSE },
+    [MESH_FORMAT_FLOAT3] = { GL_FLOAT, 3, GL_FALSE },
+    [MESH_FORMAT_FLOAT4] = { GL_FLOAT, 4, GL_FALSE },
+    [MESH_FORMAT_HALF2] = { GL_HALF_FLOAT, 2, GL_FALSE },
+    [MESH_FORMAT_HALF4] = { GL_HALF_FLOAT, 4, GL_FALSE },
+    [MESH_FORMAT_SNORM16x4] = { GL_SHORT, 4, GL_TRUE },
+    [MESH_FORMAT_UNORM16x2] = { GL_UNSIGNED_SHORT, 2, GL_TRUE },
+    [MESH_FORMAT_SNORM10x3] = { GL_INT_2_10_10_10_REV, 4, GL_TRUE },
+};
+
+// Block of count * size bytes at offset lies inside the file
+static int block_fits(size_t file_size, uint32_t offset, uint32_t count, uint32_t size) {
+    unsigned long long end = (unsigned long long)offset + (unsigned long long)count * size;
+    return end <= file_size;
+}
+
+static int check_mesh_file(const unsigned char* data, size_t size) {
+    if (size < sizeof(MeshFileHeader)) return 0;
+    const MeshFileHeader* header = (const MeshFileHeader*)data;
+    if (header->magic != MESH_MAGIC || header->version != MESH_VERSION) return 0;
+    if (header->index_size != 2 && header->index_size != 4) return 0;
+    if (header->attribute_count > MESH_ATTRIB_COUNT || header->vertex_stride == 0) return 0;
+    if (!block_fits(size, header->attribute_offset, header->attribute_count, sizeof(MeshAttribute))) return 0;
+    if (!block_fits(size, header->submesh_offset, header->submesh_count, sizeof(MeshSubmesh))) return 0;
+    if (!block_fits(size, header->vertex_offset, header->vertex_count, header->vertex_stride)) return 0;
+    if (!block_fits(size, header->index_offset, header->index_count, header->index_size)) return 0;
+
+    const MeshAttribute* attributes = (const MeshAttribute*)(data + header->attribute_offset);
+    for (uint32_t i = 0; i < header->attribute_count; i++) {
+        if (attributes[i].semantic >= MESH_ATTRIB_COUNT || attributes[i].format >= MESH_FORMAT_COUNT) return 0;
+        if (attributes[i].offset + mesh_format_size(attributes[i].format) > header->vertex_stride) return 0;
+    }
+    const MeshSubmesh* submeshes = (const MeshSubmesh*)(data + header->submesh_offset);
+    for (uint32_t i = 0; i < header->submesh_count; i++) {
+        if ((unsigned long long)submeshes[i].index_start + submeshes[i].index_count > header->index_count) return 0;
+    }
+    return 1;
+}
+
+void setup_mesh_vertex_array(const Mesh* mesh, GLuint vao, uint32_t mask) {
+    glstate_bind_vertex_array(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+    for (int i = 0; i < mesh->attribute_count; i++) {
+        const MeshAttribute* attribute = &mesh->attributes[i];
+        if (!(mask & MESH_ATTRIB_BIT(attribute->semantic))) continue;
+        GLuint location = attribute->semantic;
+        glVertexAttribPointer(location, mesh_gl_formats[attribute->format].components, mesh_gl_formats[attribute->format].type,
+                              mesh_gl_formats[attribute->format].normalized, mesh->vertex_stride, (void*)(uintptr_t)attribute->offset);
+        glEnableVertexAttribArray(location);
+    }
+}
+
+int create_mesh_from_memory(const void* data, size_t size, Mesh* mesh) {
+    memset(mesh, 0, sizeof(*mesh));
+    const unsigned char* bytes = (const unsigned char*)data;
+    if (!check_mesh_file(bytes, size)) {
+        printf("Error: Invalid mesh data\n");
+        return 0;
+    }
+    const MeshFileHeader* header = (const MeshFileHeader*)bytes;
+
+    mesh->vertex_count = (int)header->vertex_count;
+    mesh->index_count = (int)header->index_count;
+    mesh->vertex_stride = (int)header->vertex_stride;
+    mesh->index_size = (int)header->index_size;
+    mesh->index_type = header->index_size == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    mesh->attribute_count = (int)header->attribute_count;
+    memcpy(mesh->attributes, bytes + header->attribute_offset, header->attribute_count * sizeof(MeshAttribute));
+    glm_vec3_copy((float*)header->bounds_min, mesh->bounds_min);
+    glm_vec3_copy((float*)header->bounds_max, mesh->bounds_max);
+    glm_mat4_identity(mesh->dequantize);
+    for (int i = 0; i < mesh->attribute_count; i++) {
+        if (mesh->attributes[i].semantic == MESH_ATTRIB_POSITION && mesh->attributes[i].format == MESH_FORMAT_SNORM16x4) {
+            mesh->quantized = true;
+            glm_translate_make(mesh->dequantize, (float*)header->position_offset);
+            glm_scale(mesh->dequantize, (float*)header->position_scale);
+        }
+    }
+
+    mesh->submesh_count = (int)header->submesh_count;
+    if (mesh->submesh_count > 0) {
+        mesh->submeshes = (MeshSubmesh*)malloc(mesh->submesh_count * sizeof(MeshSubmesh));
+        if (!mesh->submeshes) {
+            printf("Error: Failed to allocate submeshes\n");
+            return 0;
+        }
+        memcpy(mesh->submeshes, bytes + header->submesh_offset, mesh->submesh_count * sizeof(MeshSubmesh));
+    }
+
+    // The file blocks are already in GL layout, no conversion
+    glGenVertexArrays(1, &mesh->vao);
+    glGenBuffers(1, &mesh->vbo);
+    glGenBuffers(1, &mesh->ebo);
+    glstate_bind_vertex_array(mesh->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)header->vertex_count * header->vertex_stride, bytes + header->vertex_offset, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)header->index_count * header->index_size, bytes + header->index_offset, GL_STATIC_DRAW);
+    setup_mesh_vertex_array(mesh, mesh->vao, MESH_ATTRIB_ALL);
+    glstate_bind_vertex_array(0);
+    return 1;
+}
+
+int load_mesh(const char* path, Mesh* mesh) {
+    MappedFile file;
+    if (!map_file_open(path, &file)) {
+        printf("Error: Failed to open mesh '%s'\n", path);
+        memset(mesh, 0, sizeof(*mesh));
+        return 0;
+    }
+    int ok = create_mesh_from_memory(file.data, file.size, mesh);
+    map_file_close(&file);
+    if (!ok) printf("Error: Failed to load mesh '%s'\n", path);
+    return ok;
+}
+
+void draw_submesh(const Mesh* mesh, int submesh) {
+    if (submesh < 0 || submesh >= mesh->submesh_count) return;
+    const MeshSubmesh* part = &mesh->submeshes[submesh];
+    glstate_bind_vertex_array(mesh->vao);
+    glDrawElements(GL_TRIANGLES, part->index_count, mesh->index_type, (void*)((uintptr_t)part->index_start * mesh->index_size));
+}
+
+void draw_mesh(const Mesh* mesh) {
+    glstate_bind_vertex_array(mesh->vao);
+    glDrawElements(GL_TRIANGLES, mesh->index_count, mesh->index_type, 0);
+}
+
+void get_mesh_model_matrix(const Mesh* mesh, mat4 model, mat4 dest) {
+    if (mesh->quantized) {
+        glm_mat4_mul(model, (vec4*)mesh->dequantize, dest);
+    } else {
+        glm_mat4_copy(model, dest);
+    }
+}
+
+void cleanup_mesh(Mesh* mesh) {
+    if (!mesh) return;
+    glstate_delete_vertex_array(&mesh->vao);
+    if (mesh->vbo) glDeleteBuffers(1, &mesh->vbo);
+    if (mesh->ebo) glDeleteBuffers(1, &mesh->ebo);
+    free(mesh->submeshes);
+    memset(mesh, 0, sizeof(*mesh));
+}
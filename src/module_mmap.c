@@ -0,0 +1,114 @@
+// module_mmap.c
+#include "module_mmap.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#ifdef _WIN32
+
+int map_file_open(const char* path, MappedFile* file) {
+    memset(file, 0, sizeof(*file));
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return 0;
+    }
+    file->file_handle = handle;
+    file->size = (size_t)size.QuadPart;
+    if (file->size == 0) {
+        return 1; // Nothing to map, data stays NULL
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        printf("Error: CreateFileMapping failed for '%s'\n", path);
+        CloseHandle(handle);
+        memset(file, 0, sizeof(*file));
+        return 0;
+    }
+    file->mapping_handle = mapping;
+    file->data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!file->data) {
+        printf("Error: MapViewOfFile failed for '%s'\n", path);
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        memset(file, 0, sizeof(*file));
+        return 0;
+    }
+    return 1;
+}
+
+void map_file_close(MappedFile* file) {
+    if (file->data) UnmapViewOfFile((LPCVOID)file->data);
+    if (file->mapping_handle) CloseHandle((HANDLE)file->mapping_handle);
+    if (file->file_handle) CloseHandle((HANDLE)file->file_handle);
+    memset(file, 0, sizeof(*file));
+}
+
+int make_directory(const char* path) {
+    if (_mkdir(path) == 0 || errno == EEXIST) return 1;
+    printf("Error: Failed to create directory '%s'\n", path);
+    return 0;
+}
+
+#else
+
+int map_file_open(const char* path, MappedFile* file) {
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+    file->size = (size_t)st.st_size;
+    if (file->size == 0) {
+        close(fd);
+        return 1; // Nothing to map, data stays NULL
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void* data = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Error: mmap failed for '%s'\n", path);
+        memset(file, 0, sizeof(*file));
+        return 0;
+    }
+    file->data = (const unsigned char*)data;
+    return 1;
+}
+
+void map_file_close(MappedFile* file) {
+    if (file->data) munmap((void*)file->data, file->size);
+    memset(file, 0, sizeof(*file));
+}
+
+int make_directory(const char* path) {
+    if (mkdir(path, 0755) == 0 || errno == EEXIST) return 1;
+    printf("Error: Failed to create directory '%s'\n", path);
+    return 0;
+}
+
+#endif
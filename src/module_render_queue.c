@@ -0,0 +1,155 @@
+// module_render_queue.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "module_render_queue.h"
+#include "module_arena.h"
+#include "module_glstate.h"
+
+#define RENDER_ID_BITS    10
+#define RENDER_DEPTH_BITS 24
+#define RENDER_ID_MASK    ((1u << RENDER_ID_BITS) - 1)
+#define RENDER_DEPTH_MAX  ((1u << RENDER_DEPTH_BITS) - 1)
+
+typedef struct {
+    uint64_t key;
+    uint32_t index; // Into items
+} RenderSortEntry;
+
+struct RenderQueue {
+    RenderItem* items;
+    RenderSortEntry* entries;
+    RenderSortEntry* scratch;   // Radix sort ping-pong buffer
+    int count, capacity;
+    FrameArena* arena;          // render_queue_alloc, reset on submit
+};
+
+uint64_t make_render_key(int layer, bool transparent, GLuint program, GLuint texture, GLuint vao, float depth) {
+    if (depth < 0.0f) depth = 0.0f;
+    if (depth > 1.0f) depth = 1.0f;
+    uint64_t d = (uint64_t)(depth * RENDER_DEPTH_MAX);
+    uint64_t state = ((uint64_t)(program & RENDER_ID_MASK) << (2 * RENDER_ID_BITS))
+                   | ((uint64_t)(texture & RENDER_ID_MASK) << RENDER_ID_BITS)
+                   | (uint64_t)(vao & RENDER_ID_MASK);
+    uint64_t key = (uint64_t)(layer & 0xF) << 60;
+    if (transparent) {
+        key |= 1ull << 59;
+        key |= (RENDER_DEPTH_MAX - d) << (3 * RENDER_ID_BITS + 5);
+        key |= state << 5;
+    } else {
+        key |= state << (RENDER_DEPTH_BITS + 5);
+        key |= d << 5;
+    }
+    return key;
+}
+
+int init_render_queue(RenderQueue** queue) {
+    *queue = (RenderQueue*)calloc(1, sizeof(RenderQueue));
+    if (!*queue) {
+        printf("Error: Failed to allocate RenderQueue\n");
+        return 0;
+    }
+    if (!init_frame_arena(64 * 1024, &(*queue)->arena)) {
+        free(*queue);
+        *queue = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+RenderItem* push_render_item(RenderQueue* queue, uint64_t key) {
+    if (queue->count == queue->capacity) {
+        int capacity = queue->capacity ? queue->capacity * 2 : 256;
+        RenderItem* items = (RenderItem*)realloc(queue->items, capacity * sizeof(RenderItem));
+        if (!items) goto fail;
+        queue->items = items;
+        RenderSortEntry* entries = (RenderSortEntry*)realloc(queue->entries, capacity * sizeof(RenderSortEntry));
+        if (!entries) goto fail;
+        queue->entries = entries;
+        RenderSortEntry* scratch = (RenderSortEntry*)realloc(queue->scratch, capacity * sizeof(RenderSortEntry));
+        if (!scratch) goto fail;
+        queue->scratch = scratch;
+        queue->capacity = capacity;
+    }
+    RenderItem* item = &queue->items[queue->count];
+    memset(item, 0, sizeof(*item));
+    queue->entries[queue->count].key = key;
+    queue->entries[queue->count].index = (uint32_t)queue->count;
+    queue->count++;
+    return item;
+
+fail:
+    printf("Error: Failed to grow render queue\n");
+    return NULL;
+}
+
+void* render_queue_alloc(RenderQueue* queue, size_t size) {
+    return frame_arena_alloc(queue->arena, size);
+}
+
+int get_render_queue_count(const RenderQueue* queue) {
+    return queue->count;
+}
+
+// LSD radix sort, one byte per pass; stable, so equal keys keep submission order.
+// Passes where every key has the same byte are skipped.
+static RenderSortEntry* sort_entries(RenderSortEntry* src, RenderSortEntry* dst, int count) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        int histogram[256] = {0};
+        for (int i = 0; i < count; i++) histogram[(src[i].key >> shift) & 0xFF]++;
+        if (histogram[(src[0].key >> shift) & 0xFF] == count) continue;
+
+        int offset = 0;
+        for (int b = 0; b < 256; b++) {
+            int n = histogram[b];
+            histogram[b] = offset;
+            offset += n;
+        }
+        for (int i = 0; i < count; i++) dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+        RenderSortEntry* swap = src;
+        src = dst;
+        dst = swap;
+    }
+    return src;
+}
+
+void submit_render_queue(RenderQueue* queue) {
+    if (queue->count == 0) return;
+
+    RenderSortEntry* sorted = sort_entries(queue->entries, queue->scratch, queue->count);
+
+    for (int i = 0; i < queue->count; i++) {
+        const RenderItem* item = &queue->items[sorted[i].index];
+        if (item->transparent) {
+            glstate_enable(GL_BLEND);
+            glstate_depth_mask(GL_FALSE);
+        } else {
+            glstate_disable(GL_BLEND);
+            glstate_depth_mask(GL_TRUE);
+        }
+        if (item->program) glstate_use_program(item->program);
+        if (item->vao) glstate_bind_vertex_array(item->vao);
+        if (item->texture) {
+            glstate_active_texture(GL_TEXTURE0);
+            glstate_bind_texture(GL_TEXTURE_2D, item->texture);
+        }
+        item->draw(item);
+    }
+    // Leave blending on and depth writes on, as the apps set them up
+    glstate_enable(GL_BLEND);
+    glstate_depth_mask(GL_TRUE);
+
+    queue->count = 0;
+    frame_arena_reset(queue->arena);
+}
+
+void cleanup_render_queue(RenderQueue* queue) {
+    if (!queue) return;
+    free(queue->items);
+    free(queue->entries);
+    free(queue->scratch);
+    cleanup_frame_arena(queue->arena);
+    free(queue);
+}
@@ -0,0 +1,378 @@
+// module_shader.c
+#include "module_shader.h"
+#include "module_mmap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// GL_ARB_get_program_binary (core in 4.1). glad is generated for 3.3, so the entry
+// points are loaded by init_shader_cache.
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (GLAD_API_PTR *GetProgramBinaryFunc)(GLuint program, GLsizei buf_size, GLsizei* length, GLenum* binary_format, void* binary);
+typedef void (GLAD_API_PTR *ProgramBinaryFunc)(GLuint program, GLenum binary_format, const void* binary, GLsizei length);
+typedef void (GLAD_API_PTR *ProgramParameteriFunc)(GLuint program, GLenum pname, GLint value);
+
+#define SHADER_CACHE_VERSION 1
+
+// Cached program: header followed by the driver binary
+typedef struct {
+    char magic[4];                // "SHDB"
+    unsigned int version;         // SHADER_CACHE_VERSION
+    unsigned long long key;       // Hash of the sources and the driver strings
+    unsigned int format;          // binaryFormat from glGetProgramBinary
+    unsigned int length;          // Binary size in bytes
+} ShaderCacheHeader;
+
+static struct {
+    int enabled;
+    char dir[256];
+    unsigned long long driver_hash;   // Vendor, renderer and version; a driver update invalidates every entry
+    GetProgramBinaryFunc get_program_binary;
+    ProgramBinaryFunc program_binary;
+    ProgramParameteriFunc program_parameteri;
+} shader_cache;
+
+// Every program reflected so far; a handful per app, so a flat list is enough
+static ShaderProgram** shader_programs = NULL;
+static int shader_program_count = 0;
+static int shader_program_capacity = 0;
+static unsigned int shader_serial = 0;
+
+static GLuint compile_shader_stage(GLenum type, const char* src, const char* label) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, NULL);
+    glCompileShader(shader);
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char info_log[512];
+        glGetShaderInfoLog(shader, 512, NULL, info_log);
+        printf("%s %s shader compilation failed: %s\n", label, type == GL_VERTEX_SHADER ? "vertex" : "fragment", info_log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static unsigned long long hash_shader_bytes(const void* data, size_t size, unsigned long long hash) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static int has_gl_extension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension && strcmp(extension, name) == 0) return 1;
+    }
+    return 0;
+}
+
+int init_shader_cache(const char* dir, GLADloadfunc load) {
+    memset(&shader_cache, 0, sizeof(shader_cache));
+    if (!dir || !dir[0] || !load) return 0;
+
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major * 10 + minor < 41 && !has_gl_extension("GL_ARB_get_program_binary")) {
+        printf("Shader cache: program binaries not supported\n");
+        return 0;
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        printf("Shader cache: driver offers no program binary formats\n");
+        return 0;
+    }
+
+    shader_cache.get_program_binary = (GetProgramBinaryFunc)load("glGetProgramBinary");
+    shader_cache.program_binary = (ProgramBinaryFunc)load("glProgramBinary");
+    shader_cache.program_parameteri = (ProgramParameteriFunc)load("glProgramParameteri");
+    if (!shader_cache.get_program_binary || !shader_cache.program_binary || !shader_cache.program_parameteri) {
+        printf("Shader cache: failed to load program binary functions\n");
+        return 0;
+    }
+
+    const char* strings[3] = {
+        (const char*)glGetString(GL_VENDOR),
+        (const char*)glGetString(GL_RENDERER),
+        (const char*)glGetString(GL_VERSION)
+    };
+    unsigned long long hash = 14695981039346656037ull;
+    for (int i = 0; i < 3; i++) {
+        if (strings[i]) hash = hash_shader_bytes(strings[i], strlen(strings[i]) + 1, hash);
+    }
+    shader_cache.driver_hash = hash;
+    snprintf(shader_cache.dir, sizeof(shader_cache.dir), "%s", dir);
+    shader_cache.enabled = 1;
+    return 1;
+}
+
+static unsigned long long get_shader_cache_key(const char* vs_src, const char* fs_src) {
+    unsigned long long hash = shader_cache.driver_hash;
+    hash = hash_shader_bytes(vs_src, strlen(vs_src) + 1, hash); // The terminator separates the two sources
+    hash = hash_shader_bytes(fs_src, strlen(fs_src) + 1, hash);
+    return hash;
+}
+
+static void get_shader_cache_path(unsigned long long key, char* path, size_t size) {
+    snprintf(path, size, "%s/shader_%016llx.bin", shader_cache.dir, key);
+}
+
+// Create a program from a cached binary. Returns 0 when there is no entry or the
+// driver rejects it (after an update, for example); the caller compiles instead.
+static GLuint load_program_binary(unsigned long long key) {
+    char path[320];
+    get_shader_cache_path(key, path, sizeof(path));
+    MappedFile file;
+    if (!map_file_open(path, &file)) return 0;
+
+    const ShaderCacheHeader* header = (const ShaderCacheHeader*)file.data;
+    if (file.size < sizeof(ShaderCacheHeader) || memcmp(header->magic, "SHDB", 4) != 0 ||
+        header->version != SHADER_CACHE_VERSION || header->key != key ||
+        file.size < sizeof(ShaderCacheHeader) + header->length) {
+        map_file_close(&file);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    shader_cache.program_binary(program, header->format, file.data + sizeof(ShaderCacheHeader), (GLsizei)header->length);
+    map_file_close(&file);
+
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        remove(path); // Stale, rewritten after the compile
+        return 0;
+    }
+    return program;
+}
+
+static void save_program_binary(GLuint program, unsigned long long key) {
+    if (!make_directory(shader_cache.dir)) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    void* binary = malloc(length);
+    if (!binary) return;
+    GLenum format = 0;
+    GLsizei written = 0;
+    shader_cache.get_program_binary(program, length, &written, &format, binary);
+    if (written <= 0) {
+        free(binary);
+        return;
+    }
+
+    ShaderCacheHeader header;
+    memcpy(header.magic, "SHDB", 4);
+    header.version = SHADER_CACHE_VERSION;
+    header.key = key;
+    header.format = format;
+    header.length = (unsigned int)written;
+
+    char path[320], temp_path[330];
+    get_shader_cache_path(key, path, sizeof(path));
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE* ff = fopen(temp_path, "wb");
+    if (!ff) {
+        printf("Warning: Failed to write shader cache '%s'\n", temp_path);
+        free(binary);
+        return;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, ff) == 1 &&
+             fwrite(binary, 1, (size_t)written, ff) == (size_t)written;
+    ok = (fclose(ff) == 0) && ok;
+    free(binary);
+    remove(path); // rename does not replace on Windows
+    if (!ok || rename(temp_path, path) != 0) {
+        printf("Warning: Failed to write shader cache '%s'\n", path);
+        remove(temp_path);
+    }
+}
+
+GLuint compile_shader_program(const char* vs_src, const char* fs_src, const char* label) {
+    unsigned long long key = 0;
+    if (shader_cache.enabled) {
+        key = get_shader_cache_key(vs_src, fs_src);
+        GLuint cached = load_program_binary(key);
+        if (cached) return cached;
+    }
+
+    GLuint vs = compile_shader_stage(GL_VERTEX_SHADER, vs_src, label);
+    if (!vs) return 0;
+    GLuint fs = compile_shader_stage(GL_FRAGMENT_SHADER, fs_src, label);
+    if (!fs) {
+        glDeleteShader(vs);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    if (shader_cache.enabled) shader_cache.program_parameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char info_log[512];
+        glGetProgramInfoLog(program, 512, NULL, info_log);
+        printf("%s program linking failed: %s\n", label, info_log);
+        glDeleteProgram(program);
+        return 0;
+    }
+    if (shader_cache.enabled) save_program_binary(program, key);
+    return program;
+}
+
+static unsigned int hash_uniform_name(const char* name) {
+    unsigned int hash = 2166136261u;
+    for (; *name; name++) {
+        hash ^= (unsigned char)*name;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static ShaderProgram* reflect_shader_program(GLuint program) {
+    ShaderProgram* shader = (ShaderProgram*)calloc(1, sizeof(ShaderProgram));
+    if (!shader) {
+        printf("Error: Failed to allocate ShaderProgram\n");
+        return NULL;
+    }
+    shader->id = program;
+    shader->serial = ++shader_serial;
+
+    GLint active = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &active);
+    shader->map_capacity = 16;
+    while (shader->map_capacity < active * 2) shader->map_capacity *= 2;
+    shader->uniforms = (ShaderUniform*)calloc(active > 0 ? active : 1, sizeof(ShaderUniform));
+    shader->uniform_map = (int*)calloc(shader->map_capacity, sizeof(int));
+    if (!shader->uniforms || !shader->uniform_map) {
+        printf("Error: Failed to allocate shader uniforms\n");
+        free(shader->uniforms);
+        free(shader->uniform_map);
+        free(shader);
+        return NULL;
+    }
+
+    for (GLint i = 0; i < active; i++) {
+        ShaderUniform* uniform = &shader->uniforms[shader->uniform_count];
+        GLsizei length = 0;
+        glGetActiveUniform(program, (GLuint)i, sizeof(uniform->name), &length, &uniform->size, &uniform->type, uniform->name);
+        // Arrays are reported as "name[0]"; store them under the plain name
+        if (length > 3 && strcmp(uniform->name + length - 3, "[0]") == 0) uniform->name[length - 3] = '\0';
+        uniform->location = glGetUniformLocation(program, uniform->name);
+        if (uniform->location < 0) continue; // Member of a uniform block
+
+        unsigned int mask = shader->map_capacity - 1;
+        unsigned int slot = hash_uniform_name(uniform->name) & mask;
+        while (shader->uniform_map[slot]) slot = (slot + 1) & mask;
+        shader->uniform_map[slot] = ++shader->uniform_count;
+    }
+    return shader;
+}
+
+ShaderProgram* get_shader_program(GLuint program) {
+    if (!program) return NULL;
+    for (int i = 0; i < shader_program_count; i++) {
+        if (shader_programs[i]->id == program) return shader_programs[i];
+    }
+
+    if (shader_program_count == shader_program_capacity) {
+        int capacity = shader_program_capacity ? shader_program_capacity * 2 : 16;
+        ShaderProgram** programs = (ShaderProgram**)realloc(shader_programs, capacity * sizeof(ShaderProgram*));
+        if (!programs) {
+            printf("Error: Failed to grow shader program list\n");
+            return NULL;
+        }
+        shader_programs = programs;
+        shader_program_capacity = capacity;
+    }
+    ShaderProgram* shader = reflect_shader_program(program);
+    if (!shader) return NULL;
+    shader_programs[shader_program_count++] = shader;
+    return shader;
+}
+
+ShaderProgram* create_shader_program(const char* vs_src, const char* fs_src, const char* label) {
+    GLuint program = compile_shader_program(vs_src, fs_src, label);
+    if (!program) return NULL;
+    ShaderProgram* shader = get_shader_program(program);
+    if (!shader) glDeleteProgram(program);
+    return shader;
+}
+
+void release_shader_program(GLuint program) {
+    if (!program) return;
+    for (int i = 0; i < shader_program_count; i++) {
+        if (shader_programs[i]->id != program) continue;
+        free(shader_programs[i]->uniforms);
+        free(shader_programs[i]->uniform_map);
+        free(shader_programs[i]);
+        shader_programs[i] = shader_programs[--shader_program_count];
+        break;
+    }
+    if (shader_program_count == 0) {
+        free(shader_programs);
+        shader_programs = NULL;
+        shader_program_capacity = 0;
+    }
+    glDeleteProgram(program);
+}
+
+int find_shader_uniform(const ShaderProgram* shader, const char* name) {
+    if (!shader || !name) return -1;
+    unsigned int mask = shader->map_capacity - 1;
+    unsigned int slot = hash_uniform_name(name) & mask;
+    while (shader->uniform_map[slot]) {
+        int index = shader->uniform_map[slot] - 1;
+        if (strcmp(shader->uniforms[index].name, name) == 0) return index;
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+void set_uniform_int(const ShaderProgram* shader, int uniform, int value) {
+    if (uniform >= 0) glUniform1i(shader->uniforms[uniform].location, value);
+}
+
+void set_uniform_float(const ShaderProgram* shader, int uniform, float value) {
+    if (uniform >= 0) glUniform1f(shader->uniforms[uniform].location, value);
+}
+
+void set_uniform_vec2(const ShaderProgram* shader, int uniform, float x, float y) {
+    if (uniform >= 0) glUniform2f(shader->uniforms[uniform].location, x, y);
+}
+
+void set_uniform_vec3(const ShaderProgram* shader, int uniform, float x, float y, float z) {
+    if (uniform >= 0) glUniform3f(shader->uniforms[uniform].location, x, y, z);
+}
+
+void set_uniform_vec4(const ShaderProgram* shader, int uniform, float x, float y, float z, float w) {
+    if (uniform >= 0) glUniform4f(shader->uniforms[uniform].location, x, y, z, w);
+}
+
+void set_uniform_mat4(const ShaderProgram* shader, int uniform, const float* matrix) {
+    if (uniform >= 0) glUniformMatrix4fv(shader->uniforms[uniform].location, 1, GL_FALSE, matrix);
+}
@@ -0,0 +1,300 @@
+// module_texture.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <SDL3/SDL.h>
+
+#include "module_texture.h"
+#include "module_glstate.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#define TEXTURE_MAX_WORKERS 16
+#define TEXTURE_PBO_COUNT 2 // Alternate so a new upload does not wait on the previous one
+
+struct TextureJob {
+    // Set on the render thread when queued
+    Texture* texture;           // NULL if released while loading (render thread only)
+    char* path;
+    // Set by the worker
+    unsigned char* pixels;      // RGBA8, NULL if decoding failed
+    const char* error;          // stbi_failure_reason() of the worker (it is per thread)
+    int width, height;
+    // Render thread, while uploading
+    GLuint upload_id;           // Becomes texture->id when the last row is in
+    int rows_uploaded;
+    TextureJob* next;
+};
+
+typedef struct {
+    TextureJob* head;
+    TextureJob* tail;
+} JobList;
+
+static struct {
+    bool running;
+    bool quit;
+    SDL_Thread* workers[TEXTURE_MAX_WORKERS];
+    int worker_count;
+    SDL_Mutex* mutex;           // Guards both lists and quit
+    SDL_Condition* wake;        // Signalled when a job is queued or on quit
+    JobList queued;             // Waiting for a worker
+    JobList decoded;            // Waiting for update_texture_loader
+    TextureJob* uploading;      // Render thread only
+    int pending;                // Render thread only
+    GLuint placeholder;
+    GLuint pbos[TEXTURE_PBO_COUNT];
+    int next_pbo;
+} loader;
+
+static void push_job(JobList* list, TextureJob* job) {
+    job->next = NULL;
+    if (list->tail) list->tail->next = job;
+    else list->head = job;
+    list->tail = job;
+}
+
+static TextureJob* pop_job(JobList* list) {
+    TextureJob* job = list->head;
+    if (job) {
+        list->head = job->next;
+        if (!list->head) list->tail = NULL;
+    }
+    return job;
+}
+
+static void free_job(TextureJob* job) {
+    if (job->texture) job->texture->job = NULL;
+    if (job->upload_id) glstate_delete_texture(&job->upload_id);
+    stbi_image_free(job->pixels);
+    free(job->path);
+    free(job);
+}
+
+static int texture_worker(void* data) {
+    (void)data;
+    for (;;) {
+        SDL_LockMutex(loader.mutex);
+        while (!loader.quit && !loader.queued.head) SDL_WaitCondition(loader.wake, loader.mutex);
+        if (loader.quit) {
+            SDL_UnlockMutex(loader.mutex);
+            return 0;
+        }
+        TextureJob* job = pop_job(&loader.queued);
+        SDL_UnlockMutex(loader.mutex);
+
+        int channels;
+        job->pixels = stbi_load(job->path, &job->width, &job->height, &channels, 4);
+        if (!job->pixels) job->error = stbi_failure_reason();
+
+        SDL_LockMutex(loader.mutex);
+        push_job(&loader.decoded, job);
+        SDL_UnlockMutex(loader.mutex);
+    }
+}
+
+int init_texture_loader(int worker_count) {
+    if (loader.running) return 1;
+    memset(&loader, 0, sizeof(loader));
+
+    if (worker_count <= 0) worker_count = SDL_GetNumLogicalCPUCores() - 1;
+    if (worker_count < 1) worker_count = 1;
+    if (worker_count > TEXTURE_MAX_WORKERS) worker_count = TEXTURE_MAX_WORKERS;
+
+    loader.mutex = SDL_CreateMutex();
+    loader.wake = SDL_CreateCondition();
+    if (!loader.mutex || !loader.wake) {
+        printf("Error: Failed to create texture loader lock: %s\n", SDL_GetError());
+        SDL_DestroyMutex(loader.mutex);
+        SDL_DestroyCondition(loader.wake);
+        return 0;
+    }
+    for (int i = 0; i < worker_count; i++) {
+        loader.workers[i] = SDL_CreateThread(texture_worker, "texture_worker", NULL);
+        if (!loader.workers[i]) {
+            printf("Error: Failed to start texture worker: %s\n", SDL_GetError());
+            break;
+        }
+        loader.worker_count++;
+    }
+    loader.running = true;
+    if (loader.worker_count == 0) {
+        cleanup_texture_loader();
+        return 0;
+    }
+
+    // 2x2 grey checker, bound wherever a texture is still loading
+    static const unsigned char checker[16] = {
+        160, 160, 160, 255,   96,  96,  96, 255,
+         96,  96,  96, 255,  160, 160, 160, 255
+    };
+    glGenTextures(1, &loader.placeholder);
+    glstate_bind_texture(GL_TEXTURE_2D, loader.placeholder);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, checker);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenBuffers(TEXTURE_PBO_COUNT, loader.pbos);
+    return 1;
+}
+
+void cleanup_texture_loader(void) {
+    if (!loader.running) return;
+
+    SDL_LockMutex(loader.mutex);
+    loader.quit = true;
+    SDL_BroadcastCondition(loader.wake);
+    SDL_UnlockMutex(loader.mutex);
+    for (int i = 0; i < loader.worker_count; i++) SDL_WaitThread(loader.workers[i], NULL);
+
+    // Unfinished loads: their textures keep the placeholder id, which is deleted below
+    TextureJob* job;
+    while ((job = pop_job(&loader.queued))) free_job(job);
+    while ((job = pop_job(&loader.decoded))) free_job(job);
+    if (loader.uploading) free_job(loader.uploading);
+
+    SDL_DestroyCondition(loader.wake);
+    SDL_DestroyMutex(loader.mutex);
+    glstate_delete_texture(&loader.placeholder);
+    glDeleteBuffers(TEXTURE_PBO_COUNT, loader.pbos);
+    memset(&loader, 0, sizeof(loader));
+}
+
+Texture* load_texture_async(const char* path, GLint filter) {
+    if (!loader.running) {
+        printf("Error: Texture loader is not running\n");
+        return NULL;
+    }
+    Texture* texture = (Texture*)calloc(1, sizeof(Texture));
+    TextureJob* job = (TextureJob*)calloc(1, sizeof(TextureJob));
+    size_t length = strlen(path);
+    char* path_copy = (char*)malloc(length + 1);
+    if (!texture || !job || !path_copy) {
+        printf("Error: Out of memory loading '%s'\n", path);
+        free(texture);
+        free(job);
+        free(path_copy);
+        return NULL;
+    }
+    memcpy(path_copy, path, length + 1);
+
+    texture->id = loader.placeholder;
+    texture->status = TEXTURE_PENDING;
+    texture->filter = filter;
+    texture->job = job;
+    job->texture = texture;
+    job->path = path_copy;
+    loader.pending++;
+
+    SDL_LockMutex(loader.mutex);
+    push_job(&loader.queued, job);
+    SDL_SignalCondition(loader.wake);
+    SDL_UnlockMutex(loader.mutex);
+    return texture;
+}
+
+void release_texture(Texture* texture) {
+    if (!texture) return;
+    if (texture->job) texture->job->texture = NULL; // Dropped once the worker is done with it
+    if (texture->id != loader.placeholder) glstate_delete_texture(&texture->id);
+    free(texture);
+}
+
+// The job is over: uploaded, failed or released
+static void finish_job(TextureJob* job) {
+    loader.pending--;
+    free_job(job);
+}
+
+// Take the next decoded job and create its (not yet visible) texture storage
+static TextureJob* begin_upload(void) {
+    for (;;) {
+        SDL_LockMutex(loader.mutex);
+        TextureJob* job = pop_job(&loader.decoded);
+        SDL_UnlockMutex(loader.mutex);
+        if (!job) return NULL;
+
+        if (!job->texture) {
+            finish_job(job);
+            continue;
+        }
+        if (!job->pixels) {
+            printf("Error: Failed to load texture '%s': %s\n", job->path, job->error ? job->error : "unknown");
+            job->texture->status = TEXTURE_FAILED;
+            finish_job(job);
+            continue;
+        }
+
+        glGenTextures(1, &job->upload_id);
+        glstate_bind_texture(GL_TEXTURE_2D, job->upload_id);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, job->width, job->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, job->texture->filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, job->texture->filter);
+        return job;
+    }
+}
+
+void update_texture_loader(size_t budget) {
+    if (!loader.running) return;
+
+    size_t spent = 0;
+    while (spent < budget) {
+        if (!loader.uploading) loader.uploading = begin_upload();
+        TextureJob* job = loader.uploading;
+        if (!job) break;
+        if (!job->texture) {
+            // Released halfway through
+            loader.uploading = NULL;
+            finish_job(job);
+            continue;
+        }
+
+        // As many whole rows as the budget allows, at least one so big images progress
+        size_t row_bytes = (size_t)job->width * 4;
+        int rows = (int)((budget - spent) / row_bytes);
+        if (rows == 0) {
+            if (spent > 0) break;
+            rows = 1;
+        }
+        if (rows > job->height - job->rows_uploaded) rows = job->height - job->rows_uploaded;
+        size_t bytes = rows * row_bytes;
+
+        // Orphan the PBO, copy into it and let the driver do the transfer
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, loader.pbos[loader.next_pbo]);
+        loader.next_pbo = (loader.next_pbo + 1) % TEXTURE_PBO_COUNT;
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)bytes, NULL, GL_STREAM_DRAW);
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped) {
+            memcpy(mapped, job->pixels + job->rows_uploaded * row_bytes, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glstate_bind_texture(GL_TEXTURE_2D, job->upload_id);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job->rows_uploaded, job->width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        } else {
+            // No mapping: upload from client memory instead
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glstate_bind_texture(GL_TEXTURE_2D, job->upload_id);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, job->rows_uploaded, job->width, rows, GL_RGBA, GL_UNSIGNED_BYTE,
+                            job->pixels + job->rows_uploaded * row_bytes);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        job->rows_uploaded += rows;
+        spent += bytes;
+
+        if (job->rows_uploaded == job->height) {
+            Texture* texture = job->texture;
+            texture->id = job->upload_id;
+            texture->width = job->width;
+            texture->height = job->height;
+            texture->status = TEXTURE_READY;
+            job->upload_id = 0; // Owned by the texture now
+            loader.uploading = NULL;
+            finish_job(job);
+        }
+    }
+}
+
+int get_texture_loader_pending(void) {
+    return loader.pending;
+}
@@ -0,0 +1,420 @@
+// module_transform3d.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "module_transform3d.h"
+#include "module_cube.h" // CUBE_MESH_PATH
+#include "module_camera.h"
+#include "module_glstate.h"
+#include "module_render_queue.h"
+#include "module_jobs.h"
+
+#define TRANSFORM_SLICE_SIZE 4096       // Entities per job, a multiple of the widest kernel (8)
+#define TRANSFORM_PARALLEL_MIN 16384    // Depth levels smaller than this stay on the calling thread
+
+ECS_COMPONENT_DECLARE(Position3);
+ECS_COMPONENT_DECLARE(Rotation);
+ECS_COMPONENT_DECLARE(Scale3);
+ECS_COMPONENT_DECLARE(WorldMatrix);
+
+void set_transform3d(ecs_world_t* world, ecs_entity_t entity, vec3 position, versor rotation, vec3 scale) {
+    ecs_set(world, entity, Position3, { position[0], position[1], position[2] });
+    ecs_set(world, entity, Rotation, { rotation[0], rotation[1], rotation[2], rotation[3] });
+    ecs_set(world, entity, Scale3, { scale[0], scale[1], scale[2] });
+    ecs_add(world, entity, WorldMatrix);
+}
+
+void world_matrix_to_mat4(const WorldMatrix* world, mat4 dest) {
+    for (int c = 0; c < 4; c++) {
+        dest[c][0] = world->rows[0][c];
+        dest[c][1] = world->rows[1][c];
+        dest[c][2] = world->rows[2][c];
+        dest[c][3] = c == 3 ? 1.0f : 0.0f;
+    }
+}
+
+bool init_cube_mesh(CubeContext* cube) {
+    memset(cube, 0, sizeof(*cube));
+
+    // Vertex Shader
+    const char* vertexShaderSource = "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        CAMERA_UNIFORM_BLOCK
+        "uniform mat4 model;\n"
+        "void main() {\n"
+        "   gl_Position = viewProjection * model * vec4(aPos, 1.0);\n"
+        "}\n";
+
+    // Same cube, model matrix per instance (a mat4 attribute takes locations 1..4)
+    const char* instanceVertexShaderSource = "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 1) in mat4 aModel;\n"
+        CAMERA_UNIFORM_BLOCK
+        "void main() {\n"
+        "   gl_Position = viewProjection * aModel * vec4(aPos, 1.0);\n"
+        "}\n";
+
+    // Fragment Shader (simple color)
+    const char* fragmentShaderSource = "#version 330 core\n"
+        "out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = vec4(1.0, 0.5, 0.2, 1.0);\n" // Orange color
+        "}\n";
+
+    cube->shader = create_shader_program(vertexShaderSource, fragmentShaderSource, "Cube");
+    if (!cube->shader) return false;
+    cube->instanceShader = create_shader_program(instanceVertexShaderSource, fragmentShaderSource, "Instanced cube");
+    if (!cube->instanceShader) {
+        release_shader_program(cube->shader->id);
+        cube->shader = NULL;
+        return false;
+    }
+    cube->modelUniform = find_shader_uniform(cube->shader, "model");
+    bind_camera_block(cube->shader->id);
+    bind_camera_block(cube->instanceShader->id);
+
+    // Cooked from resources/cube.obj by tools/mesh_cooker
+    if (!load_mesh(CUBE_MESH_PATH, &cube->mesh)) {
+        release_shader_program(cube->shader->id);
+        release_shader_program(cube->instanceShader->id);
+        cube->shader = NULL;
+        cube->instanceShader = NULL;
+        return false;
+    }
+
+    // Instanced VAO shares the mesh buffers; only the position is read, so the mat4
+    // attribute can take locations 1..4
+    glGenVertexArrays(1, &cube->instanceVao);
+    glGenBuffers(1, &cube->instanceVbo);
+    setup_mesh_vertex_array(&cube->mesh, cube->instanceVao, MESH_ATTRIB_BIT(MESH_ATTRIB_POSITION));
+
+    glBindBuffer(GL_ARRAY_BUFFER, cube->instanceVbo);
+    for (GLuint column = 0; column < 4; column++) {
+        glVertexAttribPointer(1 + column, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), (void*)(column * sizeof(vec4)));
+        glEnableVertexAttribArray(1 + column);
+        glVertexAttribDivisor(1 + column, 1);
+    }
+
+    glstate_bind_vertex_array(0);
+
+    return true;
+}
+
+void cleanup_cube_mesh(CubeContext* cube) {
+    if (!cube) return;
+    glstate_delete_vertex_array(&cube->instanceVao);
+    cleanup_mesh(&cube->mesh);
+    glDeleteBuffers(1, &cube->instanceVbo);
+    if (cube->shader) release_shader_program(cube->shader->id);
+    if (cube->instanceShader) release_shader_program(cube->instanceShader->id);
+    cube->shader = NULL;
+    cube->instanceShader = NULL;
+    free(cube->instanceMatrices);
+    cube->instanceMatrices = NULL;
+    cube->instanceCapacity = 0;
+}
+
+// One compose_transforms call: a table, or part of one
+typedef struct {
+    const Position3* positions;
+    const Rotation* rotations;
+    const Scale3* scales;
+    const WorldMatrix* parent;  // NULL for roots
+    WorldMatrix* worlds;
+    int count;
+} TransformSlice;
+
+// The changed tables of the depth level being collected (the system ctx)
+typedef struct {
+    TransformSlice* slices;
+    int count;
+    int capacity;
+    int entities;
+    uint64_t depth;
+} TransformLevel;
+
+static void free_transform_level(void* ctx) {
+    TransformLevel* level = (TransformLevel*)ctx;
+    free(level->slices);
+    free(level);
+}
+
+static void compose_transform_slice(void* ctx, int index) {
+    const TransformSlice* slice = &((const TransformSlice*)ctx)[index];
+    compose_transforms(slice->positions, slice->rotations, slice->scales, slice->parent, slice->worlds, slice->count);
+}
+
+// Every table of one depth is independent (parents are a level up and already final),
+// so the level is spread over the job pool; run_jobs returns once all of it is written.
+static void flush_transform_level(TransformLevel* level) {
+    if (level->entities >= TRANSFORM_PARALLEL_MIN) {
+        run_jobs(level->count, compose_transform_slice, level->slices);
+    } else {
+        for (int i = 0; i < level->count; i++) compose_transform_slice(level->slices, i);
+    }
+    level->count = 0;
+    level->entities = 0;
+}
+
+// Cut the table into slices so one big table is shared between threads too
+static void queue_transform_table(TransformLevel* level, TransformSlice table) {
+    int needed = level->count + (table.count + TRANSFORM_SLICE_SIZE - 1) / TRANSFORM_SLICE_SIZE;
+    if (needed > level->capacity) {
+        int capacity = level->capacity ? level->capacity * 2 : 256;
+        while (capacity < needed) capacity *= 2;
+        TransformSlice* slices = (TransformSlice*)realloc(level->slices, capacity * sizeof(TransformSlice));
+        if (!slices) {
+            printf("Error: Out of memory queueing transforms, updating inline\n");
+            compose_transform_slice(&table, 0);
+            return;
+        }
+        level->slices = slices;
+        level->capacity = capacity;
+    }
+
+    for (int offset = 0; offset < table.count; offset += TRANSFORM_SLICE_SIZE) {
+        TransformSlice slice = table;
+        slice.positions += offset;
+        slice.rotations += offset;
+        slice.scales += offset;
+        slice.worlds += offset;
+        slice.count = table.count - offset < TRANSFORM_SLICE_SIZE ? table.count - offset : TRANSFORM_SLICE_SIZE;
+        level->slices[level->count++] = slice;
+    }
+    level->entities += table.count;
+}
+
+// Matches every entity with the transform components plus, optionally, the nearest
+// ancestor's WorldMatrix. The cascade term hands tables over in depth order (group_id
+// is the depth), so a parent's matrix is final before its children read it, and one
+// pass per frame is enough. Each table is one compose_transforms call (SIMD, see
+// module_transform_kernel.c).
+//
+// Only changed tables are recomputed. Flecs keeps a dirty counter per table column
+// (bumped by ecs_set/ecs_modified and by systems writing it), and the query remembers
+// the counters of its [in] terms per table. The parent term counts too, so a table of
+// children is changed when its parent's table wrote WorldMatrix this frame.
+//
+// With the job pool running (module_jobs.h), the changed tables of a depth are
+// collected and computed in parallel, with a barrier before the next depth.
+void update_transform_system(ecs_iter_t *it) {
+    // Nothing moved anywhere: a static scene costs one check per table, no entity is touched
+    if (!ecs_query_changed((ecs_query_t*)it->query)) {
+        ecs_iter_fini(it);
+        return;
+    }
+
+    TransformLevel* level = (TransformLevel*)it->ctx;
+    bool parallel = level && get_job_worker_count() > 0;
+    while (ecs_iter_next(it)) {
+        if (!ecs_iter_changed(it)) {
+            // Skipped tables don't mark their WorldMatrix written, so their children stay skipped too
+            ecs_iter_skip(it);
+            continue;
+        }
+
+        TransformSlice table = {
+            .positions = ecs_field(it, Position3, 0),
+            .rotations = ecs_field(it, Rotation, 1),
+            .scales = ecs_field(it, Scale3, 2),
+            .worlds = ecs_field(it, WorldMatrix, 3),
+            // Not owned by the entities: one parent per table (ChildOf is part of the table)
+            .parent = ecs_field_is_set(it, 4) ? ecs_field(it, WorldMatrix, 4) : NULL,
+            .count = it->count
+        };
+        if (!parallel) {
+            compose_transform_slice(&table, 0);
+            continue;
+        }
+
+        // A deeper table reads matrices of the level being collected: finish that level first
+        if (it->group_id != level->depth) {
+            flush_transform_level(level);
+            level->depth = it->group_id;
+        }
+        queue_transform_table(level, table);
+    }
+    if (parallel) flush_transform_level(level);
+}
+
+// Render queue payload: the cube context plus what the item draws
+typedef struct {
+    CubeContext* cube;
+    mat4 model;     // Per-entity item
+    int count;      // Instanced item
+} QueuedCube;
+
+static void draw_queued_cube(const RenderItem* item) {
+    QueuedCube* queued = (QueuedCube*)item->data;
+    set_uniform_mat4(queued->cube->shader, queued->cube->modelUniform, (float*)queued->model);
+    glDrawElements(GL_TRIANGLES, queued->cube->mesh.index_count, queued->cube->mesh.index_type, 0);
+}
+
+static void draw_queued_cube_instances(const RenderItem* item) {
+    QueuedCube* queued = (QueuedCube*)item->data;
+    glDrawElementsInstanced(GL_TRIANGLES, queued->cube->mesh.index_count, queued->cube->mesh.index_type, 0, queued->count);
+}
+
+// One item per entity, keyed by its depth so opaque cubes draw front-to-back
+static void queue_cubes_per_entity(ecs_iter_t *it, CubeContext *cube) {
+    while (ecs_iter_next(it)) {
+        const WorldMatrix *worlds = ecs_field(it, WorldMatrix, 0);
+        for (int i = 0; i < it->count; i++) {
+            vec3 translation = { worlds[i].rows[0][3], worlds[i].rows[1][3], worlds[i].rows[2][3] };
+            uint64_t key = make_render_key(RENDER_LAYER_WORLD, false, cube->shader->id, 0, cube->mesh.vao, get_camera_depth(translation));
+            QueuedCube* queued = (QueuedCube*)render_queue_alloc(cube->queue, sizeof(QueuedCube));
+            RenderItem* item = queued ? push_render_item(cube->queue, key) : NULL;
+            if (!item) {
+                ecs_iter_fini(it);
+                return;
+            }
+            queued->cube = cube;
+            world_matrix_to_mat4(&worlds[i], queued->model);
+            get_mesh_model_matrix(&cube->mesh, queued->model, queued->model);
+            item->program = cube->shader->id;
+            item->vao = cube->mesh.vao;
+            item->draw = draw_queued_cube;
+            item->data = queued;
+        }
+    }
+}
+
+// One glUniformMatrix4fv and one glDrawElements per entity
+static void render_cubes_per_entity(ecs_iter_t *it, CubeContext *cube) {
+    if (cube->queue) {
+        queue_cubes_per_entity(it, cube);
+        return;
+    }
+    glstate_use_program(cube->shader->id);
+
+    glstate_bind_vertex_array(cube->mesh.vao);
+    while (ecs_iter_next(it)) {
+        const WorldMatrix *worlds = ecs_field(it, WorldMatrix, 0);
+        for (int i = 0; i < it->count; i++) {
+            mat4 model;
+            world_matrix_to_mat4(&worlds[i], model);
+            get_mesh_model_matrix(&cube->mesh, model, model);
+            set_uniform_mat4(cube->shader, cube->modelUniform, (float*)model);
+            glDrawElements(GL_TRIANGLES, cube->mesh.index_count, cube->mesh.index_type, 0);
+        }
+    }
+}
+
+// Gather the world matrix of every matched table into one instance buffer and draw
+// all cubes with a single glDrawElementsInstanced
+static void render_cubes_instanced(ecs_iter_t *it, CubeContext *cube) {
+    int count = 0;
+    while (ecs_iter_next(it)) {
+        const WorldMatrix *worlds = ecs_field(it, WorldMatrix, 0);
+        if (count + it->count > cube->instanceCapacity) {
+            int capacity = cube->instanceCapacity ? cube->instanceCapacity : 256;
+            while (capacity < count + it->count) capacity *= 2;
+            mat4* matrices = (mat4*)realloc(cube->instanceMatrices, capacity * sizeof(mat4));
+            if (!matrices) {
+                printf("Error: Failed to grow cube instance buffer\n");
+                ecs_iter_fini(it);
+                break;
+            }
+            cube->instanceMatrices = matrices;
+            cube->instanceCapacity = capacity;
+        }
+        for (int i = 0; i < it->count; i++) {
+            mat4* model = &cube->instanceMatrices[count + i];
+            world_matrix_to_mat4(&worlds[i], *model);
+            get_mesh_model_matrix(&cube->mesh, *model, *model);
+        }
+        count += it->count;
+    }
+    if (count == 0) return;
+
+    GLsizeiptr size = count * (GLsizeiptr)sizeof(mat4);
+    glBindBuffer(GL_ARRAY_BUFFER, cube->instanceVbo);
+    if (size > cube->instanceVboSize) {
+        cube->instanceVboSize = cube->instanceCapacity * (GLsizeiptr)sizeof(mat4);
+    }
+    // Orphan last frame's storage so the upload does not wait on its draw
+    glBufferData(GL_ARRAY_BUFFER, cube->instanceVboSize, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, cube->instanceMatrices);
+
+    if (cube->queue) {
+        QueuedCube* queued = (QueuedCube*)render_queue_alloc(cube->queue, sizeof(QueuedCube));
+        RenderItem* item = queued ? push_render_item(cube->queue, make_render_key(RENDER_LAYER_WORLD, false, cube->instanceShader->id, 0, cube->instanceVao, 0.0f)) : NULL;
+        if (!item) return;
+        queued->cube = cube;
+        queued->count = count;
+        item->program = cube->instanceShader->id;
+        item->vao = cube->instanceVao;
+        item->draw = draw_queued_cube_instances;
+        item->data = queued;
+        return;
+    }
+
+    glstate_use_program(cube->instanceShader->id);
+
+    glstate_bind_vertex_array(cube->instanceVao);
+    glDrawElementsInstanced(GL_TRIANGLES, cube->mesh.index_count, cube->mesh.index_type, 0, count);
+}
+
+// Run callback: publishes the camera once, then walks every table of the query
+void render_3d_cube_system(ecs_iter_t *it) {
+    CubeContext *cube = (CubeContext *)ecs_get_ctx(it->world);
+
+    if (!cube) {
+        printf("CubeContext is NULL in render_3d_cube_system!\n");
+        ecs_iter_fini(it);
+        return;
+    }
+
+    // Ensure depth testing is enabled (elided when it already is)
+    glstate_enable(GL_DEPTH_TEST);
+
+    // View and projection live in the camera block; this only uploads when they changed
+    update_camera_buffer();
+
+    if (cube->instanced) {
+        render_cubes_instanced(it, cube);
+    } else {
+        render_cubes_per_entity(it, cube);
+    }
+}
+
+void register_transform3d(ecs_world_t* world) {
+    ECS_COMPONENT_DEFINE(world, Position3);
+    ECS_COMPONENT_DEFINE(world, Rotation);
+    ECS_COMPONENT_DEFINE(world, Scale3);
+    ECS_COMPONENT_DEFINE(world, WorldMatrix);
+    get_transform_kernel(); // Pick the SIMD path now rather than inside a system
+
+    // One cached query; WorldMatrix(cascade) is the parent's, matched up ChildOf and sorted by depth.
+    // A run callback so unchanged frames and tables can be skipped (change detection).
+    ecs_system(world, {
+        .entity = ecs_entity(world, {
+            .name = "update_transform_system",
+            .add = ecs_ids(ecs_dependson(EcsPreUpdate))
+        }),
+        .query.terms = {
+            { .id = ecs_id(Position3), .inout = EcsIn },
+            { .id = ecs_id(Rotation), .inout = EcsIn },
+            { .id = ecs_id(Scale3), .inout = EcsIn },
+            { .id = ecs_id(WorldMatrix), .inout = EcsOut },
+            { .id = ecs_id(WorldMatrix), .src.id = EcsUp | EcsCascade, .trav = EcsChildOf, .oper = EcsOptional, .inout = EcsIn }
+        },
+        .query.flags = EcsQueryDetectChanges,
+        .ctx = calloc(1, sizeof(TransformLevel)),
+        .ctx_free = free_transform_level,
+        .run = update_transform_system
+    });
+
+    // Render uses a run callback so the camera and buffers are set up once per frame
+    ecs_system(world, {
+        .entity = ecs_entity(world, {
+            .name = "render_3d_cube_system",
+            .add = ecs_ids(ecs_dependson(EcsOnUpdate))
+        }),
+        .query.terms = {
+            { .id = ecs_id(WorldMatrix), .inout = EcsIn }
+        },
+        .run = render_3d_cube_system
+    });
+}
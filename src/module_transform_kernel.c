@@ -0,0 +1,292 @@
+// module_transform_kernel.c
+// TRS -> 3x4 affine, scalar and SIMD. The SIMD kernels turn 4 (SSE) or 8 (AVX2)
+// entities into one lane each, compose the 12 matrix entries with the same formulas
+// as the scalar loop, then transpose back. The rest of a batch goes through the scalar loop.
+
+#include <stddef.h>
+
+#include "module_transform_kernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TRANSFORM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+typedef void (*ComposeFn)(const Position3*, const Rotation*, const Scale3*, const WorldMatrix*, WorldMatrix*, int);
+
+//================================================
+// Scalar
+//================================================
+
+static void compose_scalar(const Position3* position, const Rotation* rotation, const Scale3* scale,
+                           const WorldMatrix* parent, WorldMatrix* out, int count) {
+    for (int i = 0; i < count; i++) {
+        const Rotation* q = &rotation[i];
+        // Same as glm_quat_mat4: s = 2 / |q|^2 also handles quaternions that drifted from unit length
+        float norm = q->x * q->x + q->y * q->y + q->z * q->z + q->w * q->w;
+        float s = norm > 0.0f ? 2.0f / norm : 0.0f;
+        float xx = q->x * q->x * s, yy = q->y * q->y * s, zz = q->z * q->z * s;
+        float xy = q->x * q->y * s, xz = q->x * q->z * s, yz = q->y * q->z * s;
+        float wx = q->w * q->x * s, wy = q->w * q->y * s, wz = q->w * q->z * s;
+
+        float local[3][4] = {
+            { (1.0f - (yy + zz)) * scale[i].x, (xy - wz) * scale[i].y, (xz + wy) * scale[i].z, position[i].x },
+            { (xy + wz) * scale[i].x, (1.0f - (xx + zz)) * scale[i].y, (yz - wx) * scale[i].z, position[i].y },
+            { (xz - wy) * scale[i].x, (yz + wx) * scale[i].y, (1.0f - (xx + yy)) * scale[i].z, position[i].z }
+        };
+        if (!parent) {
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 4; c++) out[i].rows[r][c] = local[r][c];
+            }
+            continue;
+        }
+        const float (*p)[4] = parent->rows;
+        for (int r = 0; r < 3; r++) {
+            for (int c = 0; c < 4; c++) {
+                out[i].rows[r][c] = p[r][0] * local[0][c] + p[r][1] * local[1][c] + p[r][2] * local[2][c];
+            }
+            out[i].rows[r][3] += p[r][3];
+        }
+    }
+}
+
+#ifdef TRANSFORM_X86
+
+//================================================
+// SSE, 4 entities
+//================================================
+
+// 4 packed float3 (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) -> one register per component
+static inline TARGET_SSE2 void load_float3x4(const float* src, __m128* x, __m128* y, __m128* z) {
+    __m128 a = _mm_loadu_ps(src);
+    __m128 b = _mm_loadu_ps(src + 4);
+    __m128 c = _mm_loadu_ps(src + 8);
+    __m128 x23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(3, 1, 3, 2));   // x2 y2 x3 z3
+    __m128 y01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 0, 2, 1));   // y0 z0 y1 y2
+    __m128 y23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(3, 2, 0, 3));   // y2 y1 y3 z3
+    __m128 z01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));   // z0 z0 z1 z1
+    __m128 z23 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));   // z2 z2 z3 z3
+    *x = _mm_shuffle_ps(a, x23, _MM_SHUFFLE(2, 0, 3, 0));
+    *y = _mm_shuffle_ps(y01, y23, _MM_SHUFFLE(2, 0, 2, 0));
+    *z = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline TARGET_SSE2 void load_float4x4(const float* src, __m128* x, __m128* y, __m128* z, __m128* w) {
+    __m128 r0 = _mm_loadu_ps(src), r1 = _mm_loadu_ps(src + 4), r2 = _mm_loadu_ps(src + 8), r3 = _mm_loadu_ps(src + 12);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    *x = r0;
+    *y = r1;
+    *z = r2;
+    *w = r3;
+}
+
+// One matrix row for 4 entities (a register per column) -> that row of each entity
+static inline TARGET_SSE2 void store_row4(WorldMatrix* out, int row, __m128 c0, __m128 c1, __m128 c2, __m128 c3) {
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(out[0].rows[row], c0);
+    _mm_storeu_ps(out[1].rows[row], c1);
+    _mm_storeu_ps(out[2].rows[row], c2);
+    _mm_storeu_ps(out[3].rows[row], c3);
+}
+
+static TARGET_SSE2 void compose_sse(const Position3* position, const Rotation* rotation, const Scale3* scale,
+                                    const WorldMatrix* parent, WorldMatrix* out, int count) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 px, py, pz, sx, sy, sz, qx, qy, qz, qw;
+        load_float3x4(&position[i].x, &px, &py, &pz);
+        load_float3x4(&scale[i].x, &sx, &sy, &sz);
+        load_float4x4(&rotation[i].x, &qx, &qy, &qz, &qw);
+
+        __m128 norm = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)), _mm_add_ps(_mm_mul_ps(qz, qz), _mm_mul_ps(qw, qw)));
+        __m128 s = _mm_and_ps(_mm_div_ps(two, norm), _mm_cmpgt_ps(norm, _mm_setzero_ps()));
+        __m128 xs = _mm_mul_ps(qx, s), ys = _mm_mul_ps(qy, s), zs = _mm_mul_ps(qz, s);
+        __m128 xx = _mm_mul_ps(qx, xs), yy = _mm_mul_ps(qy, ys), zz = _mm_mul_ps(qz, zs);
+        __m128 xy = _mm_mul_ps(qx, ys), xz = _mm_mul_ps(qx, zs), yz = _mm_mul_ps(qy, zs);
+        __m128 wx = _mm_mul_ps(qw, xs), wy = _mm_mul_ps(qw, ys), wz = _mm_mul_ps(qw, zs);
+
+        __m128 l[3][4] = {
+            { _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_add_ps(xz, wy), sz), px },
+            { _mm_mul_ps(_mm_add_ps(xy, wz), sx), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy), _mm_mul_ps(_mm_sub_ps(yz, wx), sz), py },
+            { _mm_mul_ps(_mm_sub_ps(xz, wy), sx), _mm_mul_ps(_mm_add_ps(yz, wx), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), pz }
+        };
+
+        for (int r = 0; r < 3; r++) {
+            if (!parent) {
+                store_row4(&out[i], r, l[r][0], l[r][1], l[r][2], l[r][3]);
+                continue;
+            }
+            // Same parent for the whole table: broadcast its row
+            __m128 p0 = _mm_set1_ps(parent->rows[r][0]), p1 = _mm_set1_ps(parent->rows[r][1]);
+            __m128 p2 = _mm_set1_ps(parent->rows[r][2]), p3 = _mm_set1_ps(parent->rows[r][3]);
+            __m128 c[4];
+            for (int k = 0; k < 4; k++) {
+                c[k] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p0, l[0][k]), _mm_mul_ps(p1, l[1][k])), _mm_mul_ps(p2, l[2][k]));
+            }
+            c[3] = _mm_add_ps(c[3], p3);
+            store_row4(&out[i], r, c[0], c[1], c[2], c[3]);
+        }
+    }
+    compose_scalar(position + i, rotation + i, scale + i, parent, out + i, count - i);
+}
+
+//================================================
+// AVX2, 8 entities
+//================================================
+
+static inline TARGET_AVX2 __m256 combine_halves(__m128 lo, __m128 hi) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+static TARGET_AVX2 void compose_avx2(const Position3* position, const Rotation* rotation, const Scale3* scale,
+                                     const WorldMatrix* parent, WorldMatrix* out, int count) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Loads go through the 4-wide transposes, one per half
+        __m128 a[10], b[10];
+        load_float3x4(&position[i].x, &a[0], &a[1], &a[2]);
+        load_float3x4(&position[i + 4].x, &b[0], &b[1], &b[2]);
+        load_float3x4(&scale[i].x, &a[3], &a[4], &a[5]);
+        load_float3x4(&scale[i + 4].x, &b[3], &b[4], &b[5]);
+        load_float4x4(&rotation[i].x, &a[6], &a[7], &a[8], &a[9]);
+        load_float4x4(&rotation[i + 4].x, &b[6], &b[7], &b[8], &b[9]);
+        __m256 px = combine_halves(a[0], b[0]), py = combine_halves(a[1], b[1]), pz = combine_halves(a[2], b[2]);
+        __m256 sx = combine_halves(a[3], b[3]), sy = combine_halves(a[4], b[4]), sz = combine_halves(a[5], b[5]);
+        __m256 qx = combine_halves(a[6], b[6]), qy = combine_halves(a[7], b[7]);
+        __m256 qz = combine_halves(a[8], b[8]), qw = combine_halves(a[9], b[9]);
+
+        __m256 norm = _mm256_fmadd_ps(qx, qx, _mm256_fmadd_ps(qy, qy, _mm256_fmadd_ps(qz, qz, _mm256_mul_ps(qw, qw))));
+        __m256 s = _mm256_and_ps(_mm256_div_ps(two, norm), _mm256_cmp_ps(norm, _mm256_setzero_ps(), _CMP_GT_OQ));
+        __m256 xs = _mm256_mul_ps(qx, s), ys = _mm256_mul_ps(qy, s), zs = _mm256_mul_ps(qz, s);
+        __m256 xx = _mm256_mul_ps(qx, xs), yy = _mm256_mul_ps(qy, ys), zz = _mm256_mul_ps(qz, zs);
+        __m256 xy = _mm256_mul_ps(qx, ys), xz = _mm256_mul_ps(qx, zs), yz = _mm256_mul_ps(qy, zs);
+        __m256 wx = _mm256_mul_ps(qw, xs), wy = _mm256_mul_ps(qw, ys), wz = _mm256_mul_ps(qw, zs);
+
+        __m256 l[3][4] = {
+            { _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_add_ps(xz, wy), sz), px },
+            { _mm256_mul_ps(_mm256_add_ps(xy, wz), sx), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz), py },
+            { _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), pz }
+        };
+
+        for (int r = 0; r < 3; r++) {
+            __m256 c[4];
+            if (!parent) {
+                for (int k = 0; k < 4; k++) c[k] = l[r][k];
+            } else {
+                __m256 p0 = _mm256_set1_ps(parent->rows[r][0]), p1 = _mm256_set1_ps(parent->rows[r][1]);
+                __m256 p2 = _mm256_set1_ps(parent->rows[r][2]);
+                for (int k = 0; k < 4; k++) {
+                    c[k] = _mm256_fmadd_ps(p0, l[0][k], _mm256_fmadd_ps(p1, l[1][k], _mm256_mul_ps(p2, l[2][k])));
+                }
+                c[3] = _mm256_add_ps(c[3], _mm256_set1_ps(parent->rows[r][3]));
+            }
+            store_row4(&out[i], r, _mm256_castps256_ps128(c[0]), _mm256_castps256_ps128(c[1]),
+                       _mm256_castps256_ps128(c[2]), _mm256_castps256_ps128(c[3]));
+            store_row4(&out[i + 4], r, _mm256_extractf128_ps(c[0], 1), _mm256_extractf128_ps(c[1], 1),
+                       _mm256_extractf128_ps(c[2], 1), _mm256_extractf128_ps(c[3], 1));
+        }
+    }
+    compose_scalar(position + i, rotation + i, scale + i, parent, out + i, count - i);
+}
+
+static int cpu_has_avx2(void) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return 0;
+    __cpuid(info, 1);
+    int fma = (info[2] >> 12) & 1, osxsave = (info[2] >> 27) & 1, avx = (info[2] >> 28) & 1;
+    if (!fma || !osxsave || !avx) return 0;
+    if ((_xgetbv(0) & 6) != 6) return 0; // OS saves the YMM registers
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+static int cpu_has_sse2(void) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return 1; // Part of x86-64
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] >> 26) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+#endif // TRANSFORM_X86
+
+//================================================
+// Dispatch
+//================================================
+
+static const ComposeFn kernels[TRANSFORM_KERNEL_COUNT] = {
+    compose_scalar,
+#ifdef TRANSFORM_X86
+    compose_sse,
+    compose_avx2,
+#else
+    NULL,
+    NULL,
+#endif
+};
+
+static int kernel_selected = -1;
+
+int transform_kernel_supported(TransformKernel kernel) {
+    switch (kernel) {
+        case TRANSFORM_KERNEL_SCALAR: return 1;
+#ifdef TRANSFORM_X86
+        case TRANSFORM_KERNEL_SSE: return cpu_has_sse2();
+        case TRANSFORM_KERNEL_AVX2: return cpu_has_avx2();
+#endif
+        default: return 0;
+    }
+}
+
+int select_transform_kernel(TransformKernel kernel) {
+    if (kernel < 0 || kernel >= TRANSFORM_KERNEL_COUNT || !transform_kernel_supported(kernel)) return 0;
+    kernel_selected = kernel;
+    return 1;
+}
+
+TransformKernel get_transform_kernel(void) {
+    if (kernel_selected < 0) {
+        // Widest the CPU runs
+        kernel_selected = TRANSFORM_KERNEL_SCALAR;
+        for (int kernel = TRANSFORM_KERNEL_COUNT - 1; kernel > TRANSFORM_KERNEL_SCALAR; kernel--) {
+            if (transform_kernel_supported((TransformKernel)kernel)) {
+                kernel_selected = kernel;
+                break;
+            }
+        }
+    }
+    return (TransformKernel)kernel_selected;
+}
+
+const char* transform_kernel_name(TransformKernel kernel) {
+    static const char* names[TRANSFORM_KERNEL_COUNT] = { "scalar", "sse", "avx2" };
+    return kernel >= 0 && kernel < TRANSFORM_KERNEL_COUNT ? names[kernel] : "?";
+}
+
+void compose_transforms(const Position3* position, const Rotation* rotation, const Scale3* scale,
+                        const WorldMatrix* parent, WorldMatrix* out, int count) {
+    kernels[get_transform_kernel()](position, rotation, scale, parent, out, count);
+}
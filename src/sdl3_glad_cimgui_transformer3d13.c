@@ -4,6 +4,7 @@
 #include <glad/gl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <math.h>
 
 #include <cimgui.h>
@@ -12,6 +13,13 @@
 #include "module_font.h"
 #include <cglm/cglm.h> // Include CGLM
 #include "flecs.h"
+#include "module_transform3d.h"
+#include "module_shader.h"
+#include "module_camera.h"
+#include "module_glstate.h"
+#include "module_render_queue.h"
+#include "module_jobs.h"
+#include "module_hierarchy.h"
 
 #define igGetIO igGetIO_Nil
 
@@ -25,256 +33,30 @@ typedef struct {
     float y;
 } Velocity;
 
-typedef struct {
-    vec3 position; // Vector3 for position (x, y, z)
-    vec4 rotation; // Quaternion (x, y, z, w)
-    vec3 scale;    // Scale (x, y, z)
-    mat4 local;    // Local transformation matrix
-    mat4 world;    // World transformation matrix
-    bool isDirty;  // Flag to indicate if transform needs recalculation
-    ecs_entity_t parent; // Explicit parent entity reference (optional, for clarity)
-} Transform3D;
-ECS_COMPONENT_DECLARE(Transform3D);
-
-typedef struct {
-    GLuint vao, vbo, ebo; // OpenGL buffer objects
-    GLuint shaderProgram; // Shader program for the cube
-    int indexCount;       // Number of indices for rendering
-} CubeContext;
-
-// Define the Transform3DContext struct
-typedef struct {
-    const char* name;  // Entity name (pointer to Flecs-managed string)
-    ecs_entity_t id;   // Entity ID
-} Transform3DContext;
-
-// Cube vertices: position (x, y, z)
-static const float cubeVertices[] = {
-    // Front face
-    -0.5f, -0.5f,  0.5f, // 0
-     0.5f, -0.5f,  0.5f, // 1
-     0.5f,  0.5f,  0.5f, // 2
-    -0.5f,  0.5f,  0.5f, // 3
-    // Back face
-    -0.5f, -0.5f, -0.5f, // 4
-     0.5f, -0.5f, -0.5f, // 5
-     0.5f,  0.5f, -0.5f, // 6
-    -0.5f,  0.5f, -0.5f  // 7
-};
-
-// Indices for the cube (6 faces, 2 triangles per face, 3 vertices per triangle)
-static const unsigned int cubeIndices[] = {
-    // Front
-    0, 1, 2,  2, 3, 0,
-    // Right
-    1, 5, 6,  6, 2, 1,
-    // Back
-    5, 4, 7,  7, 6, 5,
-    // Left
-    4, 0, 3,  3, 7, 4,
-    // Top
-    3, 2, 6,  6, 7, 3,
-    // Bottom
-    4, 5, 1,  1, 0, 4
-};
-
-bool init_cube_mesh(CubeContext* cube) {
-    // Vertex Shader
-    const char* vertexShaderSource = "#version 330 core\n"
-        "layout (location = 0) in vec3 aPos;\n"
-        "uniform mat4 model;\n"
-        "uniform mat4 view;\n"
-        "uniform mat4 projection;\n"
-        "void main() {\n"
-        "   gl_Position = projection * view * model * vec4(aPos, 1.0);\n"
-        "}\n";
-
-    // Fragment Shader (simple color)
-    const char* fragmentShaderSource = "#version 330 core\n"
-        "out vec4 FragColor;\n"
-        "void main() {\n"
-        "   FragColor = vec4(1.0, 0.5, 0.2, 1.0);\n" // Orange color
-        "}\n";
-
-    // Compile shaders
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        printf("Vertex Shader Compilation Failed: %s\n", infoLog);
-        return false;
+// Outliner row for a hierarchy node and, when open, its children. The subtree is the
+// run of nodes after it, so children are found by skipping whole subtrees.
+static void draw_outliner_node(ecs_world_t* world, const HierarchyCache* hierarchy, int index, ecs_entity_t* selected_id) {
+    const HierarchyNode* node = &hierarchy->nodes[index];
+    const char* name = ecs_get_name(world, node->entity);
+
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_DefaultOpen;
+    if (node->subtree == 1) flags |= ImGuiTreeNodeFlags_Leaf;
+    if (node->entity == *selected_id) flags |= ImGuiTreeNodeFlags_Selected;
+
+    bool open = igTreeNodeEx_Ptr((void*)(uintptr_t)node->entity, flags, "%s (ID: %llu)",
+                                 name ? name : "Unnamed Entity", (unsigned long long)node->entity);
+    if (igIsItemClicked(ImGuiMouseButton_Left) && !igIsItemToggledOpen()) {
+        *selected_id = node->entity;
+        printf("Selected Entity: %s (ID: %llu)\n", name ? name : "Unnamed Entity", (unsigned long long)node->entity);
     }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        printf("Fragment Shader Compilation Failed: %s\n", infoLog);
-        return false;
-    }
-
-    cube->shaderProgram = glCreateProgram();
-    glAttachShader(cube->shaderProgram, vertexShader);
-    glAttachShader(cube->shaderProgram, fragmentShader);
-    glLinkProgram(cube->shaderProgram);
-    glGetProgramiv(cube->shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(cube->shaderProgram, 512, NULL, infoLog);
-        printf("Shader Program Linking Failed: %s\n", infoLog);
-        return false;
-    }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    // Setup VAO, VBO, EBO
-    glGenVertexArrays(1, &cube->vao);
-    glGenBuffers(1, &cube->vbo);
-    glGenBuffers(1, &cube->ebo);
-
-    glBindVertexArray(cube->vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, cube->vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cube->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeIndices), cubeIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glBindVertexArray(0);
-
-    cube->indexCount = sizeof(cubeIndices) / sizeof(cubeIndices[0]);
-    return true;
-}
-
-
-
-void update_transform_system(ecs_iter_t *it) {
-    Transform3D *transforms = ecs_field(it, Transform3D, 0);
-
-    for (int i = 0; i < it->count; i++) {
-        Transform3D *transform = &transforms[i];
-        if (!transform->isDirty) continue;
-
-        // Calculate local matrix: TRS order (Translate, Rotate, Scale)
-        mat4 local;
-        glm_mat4_identity(local);
-
-        // Translate
-        glm_translate(local, transform->position);
-
-        // Rotate
-        mat4 rot;
-        glm_quat_mat4(transform->rotation, rot);
-        glm_mat4_mul(local, rot, local);
-
-        // Scale
-        glm_scale(local, transform->scale);
-
-        glm_mat4_copy(local, transform->local);
-
-        // Check for parent transform
-        ecs_entity_t parent = ecs_get_parent(it->world, it->entities[i]);
-        if (parent && ecs_is_valid(it->world, parent) && ecs_has(it->world, parent, Transform3D)) {
-            const Transform3D *parent_transform = ecs_get(it->world, parent, Transform3D);
-            if (parent_transform) {
-                mat4 world;
-                glm_mat4_mul((float (*)[4])parent_transform->world, transform->local, world); // Corrected cast
-                glm_mat4_copy(world, transform->world);
-            }
-        } else {
-            glm_mat4_copy(local, transform->world);
+    if (open) {
+        for (int child = index + 1; child < index + node->subtree; child += hierarchy->nodes[child].subtree) {
+            draw_outliner_node(world, hierarchy, child, selected_id);
         }
-
-        transform->isDirty = false;
-
-        // Mark children as dirty to ensure they update
-        ecs_query_t *query_child = ecs_query(it->world, {
-            .terms = {
-                { .id = ecs_pair(EcsChildOf, it->entities[i]) }
-            }
-        });
-        ecs_iter_t child_it = ecs_query_iter(it->world, query_child);
-
-        while (ecs_query_next(&child_it)) {
-            for (int j = 0; j < child_it.count; j++) {
-                if (ecs_has(child_it.world, child_it.entities[j], Transform3D)) {
-                    Transform3D *child_transform = ecs_get_mut(child_it.world, child_it.entities[j], Transform3D);
-                    if (child_transform) {
-                        child_transform->isDirty = true;
-                        ecs_modified(child_it.world, child_it.entities[j], Transform3D);
-                    }
-                }
-            }
-        }
-        ecs_query_fini(query_child);
+        igTreePop();
     }
 }
 
-
-void render_3d_cube_system(ecs_iter_t *it) {
-    Transform3D *transforms = ecs_field(it, Transform3D, 0);
-    CubeContext *cube = (CubeContext *)ecs_get_ctx(it->world);
-    
-    if (!cube) {
-        printf("CubeContext is NULL in render_3d_cube_system!\n");
-        return;
-    }
-
-    // printf("Rendering %d cubes\n", it->count);
-    if (it->count == 0) {
-        printf("No entities with Transform3D found!\n");
-        return;
-    }
-
-    glUseProgram(cube->shaderProgram);
-
-    // Ensure depth testing is enabled
-    glEnable(GL_DEPTH_TEST);
-
-    // Setup view and projection matrices
-    mat4 view, projection;
-    glm_mat4_identity(view);
-    glm_lookat((vec3){0.0f, 0.0f, 5.0f}, (vec3){0.0f, 0.0f, 0.0f}, (vec3){0.0f, 1.0f, 0.0f}, view);
-
-    int ww, hh;
-    SDL_GetWindowSize(SDL_GL_GetCurrentWindow(), &ww, &hh);
-    glm_perspective(glm_rad(45.0f), (float)ww / hh, 0.1f, 100.0f, projection);
-
-    GLint modelLoc = glGetUniformLocation(cube->shaderProgram, "model");
-    GLint viewLoc = glGetUniformLocation(cube->shaderProgram, "view");
-    GLint projLoc = glGetUniformLocation(cube->shaderProgram, "projection");
-
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, (float*)view);
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, (float*)projection);
-
-    glBindVertexArray(cube->vao);
-    for (int i = 0; i < it->count; i++) {
-        // printf("Rendering cube %d: Pos=(%.2f, %.2f, %.2f), Rot=(%.2f, %.2f, %.2f, %.2f), Scale=(%.2f, %.2f, %.2f)\n",
-        //        i, transforms[i].position[0], transforms[i].position[1], transforms[i].position[2],
-        //        transforms[i].rotation[0], transforms[i].rotation[1], transforms[i].rotation[2], transforms[i].rotation[3],
-        //        transforms[i].scale[0], transforms[i].scale[1], transforms[i].scale[2]);
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, (float*)transforms[i].world);
-        glDrawElements(GL_TRIANGLES, cube->indexCount, GL_UNSIGNED_INT, 0);
-    }
-    glBindVertexArray(0);
-
-    // Check for OpenGL errors
-    // GLenum err;
-    // while ((err = glGetError()) != GL_NO_ERROR) {
-    //     printf("OpenGL Error in render_3d_cube_system: %u\n", err);
-    // }
-}
-
 // nope error on attach child
 void start_up_system(ecs_iter_t *it) {
     printf("start up\n");
@@ -320,6 +102,9 @@ int main() {
     }
     printf("OpenGL loaded: version %s\n", glGetString(GL_VERSION));
 
+    // Linked shader programs are kept in cache/ so later runs skip GLSL compilation
+    init_shader_cache("cache", (GLADloadfunc)SDL_GL_GetProcAddress);
+
     FontData *font_data = NULL;
     if (!init_font("resources/Kenney Mini.ttf", 32.0f, main_scale, &font_data)) {
         SDL_GL_DestroyContext(gl_context);
@@ -366,21 +151,22 @@ int main() {
     clearColorE3.z = 0.60f;
     clearColorE3.w = 1.00f;
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glstate_enable(GL_BLEND);
+    glstate_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     float clear_color[4] = {0.45f, 0.55f, 0.60f, 1.00f};
     bool done = false;
     const char* text = "Hello World! Glad 2.0.8";
 
+    // Worker threads for update_transform_system; without them it runs serially
+    init_job_pool(0);
+
     ecs_world_t *world = ecs_init();
     CubeContext* cube;
 
     ECS_COMPONENT(world, Position);
     ECS_COMPONENT(world, Velocity);
     // ECS_COMPONENT(world, CubeContext);
-    // ECS_COMPONENT(world, Transform3D);
-    ECS_COMPONENT_DEFINE(world, Transform3D);// need to able to access for system get component
 
     // EcsOnStart
     // EcsPreUpdate
@@ -389,43 +175,42 @@ int main() {
 
     // start up system
     ECS_SYSTEM(world, start_up_system, EcsOnStart);
-    ECS_SYSTEM(world, update_transform_system, EcsPreUpdate, Transform3D);
-    //render 3d cube
-    ECS_SYSTEM(world, render_3d_cube_system, EcsOnUpdate, Transform3D);
+    // Transform components, update_transform_system and render_3d_cube_system (module_transform3d)
+    register_transform3d(world);
+    // Camera3D and update_camera_system (module_camera)
+    register_camera(world);
+    // Flat depth-first hierarchy for the outliner, rebuilt only when ChildOf changes (module_hierarchy)
+    HierarchyCache* hierarchy = create_hierarchy_cache(world);
+
+    ecs_entity_t camera = ecs_entity(world, { .name = "Camera" });
+    ecs_set(world, camera, Camera3D, {
+        .position = {0.0f, 0.0f, 5.0f},
+        .target = {0.0f, 0.0f, 0.0f},
+        .up = {0.0f, 1.0f, 0.0f},
+        .fov = 45.0f,
+        .nearPlane = 0.1f,
+        .farPlane = 100.0f,
+        .isDirty = true
+    });
 
     // Create parent cube
     ecs_entity_t parent = ecs_entity(world, { .name = "ParentCube" });
-    ecs_set(world, parent, Transform3D, {
-        .position = {0.0f, 0.0f, 0.0f},
-        .rotation = {0.0f, 0.0f, 0.0f, 1.0f},
-        .scale = {1.0f, 1.0f, 1.0f},
-        .isDirty = true,
-        .parent = 0
-    });
+    set_transform3d(world, parent, (vec3){0.0f, 0.0f, 0.0f}, (versor){0.0f, 0.0f, 0.0f, 1.0f}, (vec3){1.0f, 1.0f, 1.0f});
 
     // Create child cube
     ecs_entity_t child = ecs_entity(world, { .name = "ChildCube" });
-    ecs_set(world, child, Transform3D, {
-        // .position = {2.0f, 0.0f, 0.0f}, // Offset from parent
-        .position = {1.0f, 0.0f, 0.0f}, // Offset from parent
-        // .position = {0.0f, 0.0f, 0.0f}, // Offset from parent
-        // .rotation = {0.0f, 0.0f, 0.0f, 1.0f},
-        .rotation = {0.0f, sinf(glm_rad(22.5f)), 0.0f, cosf(glm_rad(22.5f))},
-        .scale = {1.0f, 1.0f, 1.0f},
-        .isDirty = true,
-        .parent = parent
-    });
+    set_transform3d(world, child,
+        (vec3){1.0f, 0.0f, 0.0f}, // Offset from parent
+        (versor){0.0f, sinf(glm_rad(22.5f)), 0.0f, cosf(glm_rad(22.5f))},
+        (vec3){1.0f, 1.0f, 1.0f});
     ecs_add_pair(world, child, EcsChildOf, parent);
 
     // Create a grandchild cube for testing deeper hierarchy
     ecs_entity_t grandchild = ecs_entity(world, { .name = "GrandchildCube" });
-    ecs_set(world, grandchild, Transform3D, {
-        .position = {0.5f, 0.5f, 0.0f},
-        .rotation = {0.0f, 0.0f, sinf(glm_rad(22.5f)), cosf(glm_rad(22.5f))},
-        .scale = {0.5f, 0.5f, 0.5f},
-        .isDirty = true,
-        .parent = child
-    });
+    set_transform3d(world, grandchild,
+        (vec3){0.5f, 0.5f, 0.0f},
+        (versor){0.0f, 0.0f, sinf(glm_rad(22.5f)), cosf(glm_rad(22.5f))},
+        (vec3){0.5f, 0.5f, 0.5f});
     ecs_add_pair(world, grandchild, EcsChildOf, child);
 
     // Initialize cube mesh
@@ -436,12 +221,16 @@ int main() {
     }
     ecs_set_ctx(world, cube, NULL);
 
+    // Cubes are drawn from the render queue, sorted, after ecs_progress
+    RenderQueue* render_queue = NULL;
+    if (init_render_queue(&render_queue)) {
+        cube->queue = render_queue;
+    }
+
     // Do the ECS stuff
     ecs_entity_t e = ecs_entity(world, { .name = "Bob" });
     printf("Entity name: %s\n", ecs_get_name(world, e));
 
-    Transform3DContext* contexts = NULL; // Persist array between frames
-
     while (!done) {
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
@@ -457,6 +246,8 @@ int main() {
             continue;
         }
 
+        glstate_begin_frame(); // GL state counters are per frame
+
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL3_NewFrame();
@@ -465,105 +256,71 @@ int main() {
         // Transform 3D Context and list
         {
             
-            static int context_count = 0;              // Number of contexts
             static ecs_entity_t selected_id = 0;       // Track selected entity
 
             igBegin("transform3d", NULL, 0);
-            ImVec2 buttonSize = {0, 0};
-            if (igButton("query Transform3Ds", buttonSize)){
-
-                ecs_query_t *query0 = ecs_query(world, {
-                    .terms = {
-                        { .id = ecs_id(Transform3D) }
-                    }
-                });
-                ecs_iter_t it = ecs_query_iter(world, query0);
-
-                // First, count total entities to allocate memory
-                int total_count = 0;
-                while (ecs_query_next(&it)) {
-                    total_count += it.count;
-                }
-
-                // Resize or allocate contexts array
-                if (total_count != context_count) {
-                    contexts = realloc(contexts, total_count * sizeof(Transform3DContext));
-                    context_count = total_count;
+            igCheckbox("instanced cubes", &cube->instanced);
+            const GLStateStats* gl_stats = glstate_get_stats();
+            igText("GL state calls: %u issued, %u elided", gl_stats->total_issued, gl_stats->total_elided);
+
+            // Outliner: one pass over the cached depth-first nodes, roots are every subtree start
+            update_hierarchy_cache(hierarchy);
+            if (hierarchy) {
+                if (find_hierarchy_node(hierarchy, selected_id) < 0) selected_id = 0; // Deleted
+                for (int i = 0; i < hierarchy->count; i += hierarchy->nodes[i].subtree) {
+                    draw_outliner_node(world, hierarchy, i, &selected_id);
                 }
-
-                // Reset iterator and populate contexts
-                it = ecs_query_iter(world, query0);
-                int index = 0;
-                while (ecs_query_next(&it)) {
-                    for (int i = 0; i < it.count; i++) {
-                        // contexts[index].name = ecs_get_name(world, it.entities[i]);
-                        const char* name = ecs_get_name(world, it.entities[i]);
-                        contexts[index].name = name ? name : "Unnamed Entity"; // Fallback for NULL name
-                        contexts[index].id = it.entities[i];
-                        printf("Name: %s, ID: %llu\n", contexts[index].name, contexts[index].id);
-                        index++;
-                    }
-                }
-                //clean up
-                ecs_query_fini(query0);
             }
 
-            // Display buttons for each context
-            for (int i = 0; i < context_count; i++) {
-                char button_label[128];
-                snprintf(button_label, sizeof(button_label), "%s (ID: %llu)", 
-                        contexts[i].name, contexts[i].id);
-                if (igButton(button_label, buttonSize)) {
-                    selected_id = contexts[i].id; // Update selected entity
-                    printf("Selected Entity: %s (ID: %llu)\n", contexts[i].name, selected_id);
-                }
-            }
-
-            // Display Transform3D inputs for selected entity
+            // Display transform inputs for selected entity
             if (selected_id != 0) {
-                // Find the name of the selected entity
-                const char* selected_name = "Unknown Entity";
-                for (int i = 0; i < context_count; i++) {
-                    if (contexts[i].id == selected_id) {
-                        selected_name = contexts[i].name;
-                        break;
-                    }
-                }
+                const char* selected_name = ecs_get_name(world, selected_id);
+                if (!selected_name) selected_name = "Unnamed Entity";
                 // Display selected entity name
                 char selected_label[128];
                 snprintf(selected_label, sizeof(selected_label), "Selected: %s (ID: %llu)", 
                         selected_name, selected_id);
                 igText(selected_label);
                 
-                Transform3D* transform = ecs_get_mut(world, selected_id, Transform3D);
-                if (transform) {
-                    bool changed = false;
-
+                Position3* position = ecs_get_mut(world, selected_id, Position3);
+                Rotation* rotation = ecs_get_mut(world, selected_id, Rotation);
+                Scale3* scale = ecs_get_mut(world, selected_id, Scale3);
+                if (position && rotation && scale) {
                     // Position input fields
                     igText("Position");
-                    changed |= igInputFloat("X##pos", &transform->position[0], 0.1f, 1.0f, "%.3f", 0);
-                    changed |= igInputFloat("Y##pos", &transform->position[1], 0.1f, 1.0f, "%.3f", 0);
-                    changed |= igInputFloat("Z##pos", &transform->position[2], 0.1f, 1.0f, "%.3f", 0);
+                    bool position_changed = false;
+                    position_changed |= igInputFloat("X##pos", &position->x, 0.1f, 1.0f, "%.3f", 0);
+                    position_changed |= igInputFloat("Y##pos", &position->y, 0.1f, 1.0f, "%.3f", 0);
+                    position_changed |= igInputFloat("Z##pos", &position->z, 0.1f, 1.0f, "%.3f", 0);
 
                     // Rotation sliders (-1 to 1)
                     igText("Rotation");
-                    changed |= igSliderFloat("X##rot", &transform->rotation[0], -1.0f, 1.0f, "%.3f", 0);
-                    changed |= igSliderFloat("Y##rot", &transform->rotation[1], -1.0f, 1.0f, "%.3f", 0);
-                    changed |= igSliderFloat("Z##rot", &transform->rotation[2], -1.0f, 1.0f, "%.3f", 0);
-                    changed |= igSliderFloat("W##rot", &transform->rotation[3], -1.0f, 1.0f, "%.3f", 0);
+                    bool rotation_changed = false;
+                    rotation_changed |= igSliderFloat("X##rot", &rotation->x, -1.0f, 1.0f, "%.3f", 0);
+                    rotation_changed |= igSliderFloat("Y##rot", &rotation->y, -1.0f, 1.0f, "%.3f", 0);
+                    rotation_changed |= igSliderFloat("Z##rot", &rotation->z, -1.0f, 1.0f, "%.3f", 0);
+                    rotation_changed |= igSliderFloat("W##rot", &rotation->w, -1.0f, 1.0f, "%.3f", 0);
 
                     // Scale input fields
                     igText("Scale");
-                    changed |= igInputFloat("X##scale", &transform->scale[0], 0.1f, 1.0f, "%.3f", 0);
-                    changed |= igInputFloat("Y##scale", &transform->scale[1], 0.1f, 1.0f, "%.3f", 0);
-                    changed |= igInputFloat("Z##scale", &transform->scale[2], 0.1f, 1.0f, "%.3f", 0);
-
-                    // Mark transform as dirty if changed
-                    if (changed) {
-                        glm_quat_normalize(transform->rotation);
-                        transform->isDirty = true;
-                        ecs_modified(world, selected_id, Transform3D);
+                    bool scale_changed = false;
+                    scale_changed |= igInputFloat("X##scale", &scale->x, 0.1f, 1.0f, "%.3f", 0);
+                    scale_changed |= igInputFloat("Y##scale", &scale->y, 0.1f, 1.0f, "%.3f", 0);
+                    scale_changed |= igInputFloat("Z##scale", &scale->z, 0.1f, 1.0f, "%.3f", 0);
+
+                    if (position_changed) ecs_modified(world, selected_id, Position3);
+                    if (rotation_changed) {
+                        // Renormalize (Rotation is not 16-byte aligned, so not through glm_quat_normalize)
+                        float length = sqrtf(rotation->x * rotation->x + rotation->y * rotation->y + rotation->z * rotation->z + rotation->w * rotation->w);
+                        if (length > 0.0f) {
+                            rotation->x /= length;
+                            rotation->y /= length;
+                            rotation->z /= length;
+                            rotation->w /= length;
+                        }
+                        ecs_modified(world, selected_id, Rotation);
                     }
+                    if (scale_changed) ecs_modified(world, selected_id, Scale3);
                 }
             }
             igEnd();
@@ -574,13 +331,14 @@ int main() {
         int ww, hh;
         SDL_GetWindowSize(window, &ww, &hh);
         glViewport(0, 0, ww, hh);
+        set_camera_viewport(ww, hh); // Projection is rebuilt only when this changes
         glViewport(0, 0, (int)io->DisplaySize.x, (int)io->DisplaySize.y); //cimgui
         glClearColor(clear_colorE4[0], clear_colorE4[1], clear_colorE4[2], clear_colorE4[3]);
         // glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
         // glClear(GL_COLOR_BUFFER_BIT);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         // Enable depth testing for 3D rendering
-        glEnable(GL_DEPTH_TEST);
+        glstate_enable(GL_DEPTH_TEST);
 
         // Test cube rendering
         // {
@@ -622,6 +380,7 @@ int main() {
         
 
         ecs_progress(world, 0); // run systems in default pipeline
+        if (render_queue) submit_render_queue(render_queue);
 
 
         // Render 2D text
@@ -629,24 +388,19 @@ int main() {
         render_text(font_data, program, vao, vbo, "Hello, World!", 100.0f, 100.0f, ww, hh, 1.0f, 1.0f, 1.0f, 1.0f);
 
         ImGui_ImplOpenGL3_RenderDrawData(igGetDrawData());
+        glstate_invalidate(); // ImGui's backend binds GL state directly
         SDL_GL_SwapWindow(window);
     }
 
     // Cleanup
-    if (contexts) {
-        free(contexts);
-        contexts = NULL;
-    }
-
     // CubeContext* cube = ecs_get_ctx(world);
     // cube = ecs_get_ctx(world);
     if (cube) {
-        glDeleteVertexArrays(1, &cube->vao);
-        glDeleteBuffers(1, &cube->vbo);
-        glDeleteBuffers(1, &cube->ebo);
-        glDeleteProgram(cube->shaderProgram);
+        cleanup_cube_mesh(cube);
         free(cube);
     }
+    cleanup_camera();
+    cleanup_render_queue(render_queue);
     
 
     ImGui_ImplOpenGL3_Shutdown();
@@ -654,11 +408,12 @@ int main() {
     igDestroyContext(NULL);
     
     cleanup_font(font_data); // conflict due cimgui modified font match data type.
-    glDeleteProgram(program);
+    release_shader_program(program);
     glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
+    glstate_delete_vertex_array(&vao);
 
     ecs_fini(world);
+    cleanup_job_pool();
     
     SDL_GL_DestroyContext(gl_context);
     SDL_DestroyWindow(window);
@@ -0,0 +1,910 @@
+// mesh_cooker.c
+// Offline converter: OBJ or glTF (.gltf/.glb) in, .mesh out (see mesh_format.h).
+// All parsing happens here so the runtime only maps the file and uploads it.
+//
+// usage: mesh_cooker [options] input.obj|input.gltf|input.glb output.mesh (see print_usage)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <float.h>
+#include <math.h>
+
+#define CGLTF_IMPLEMENTATION
+#include "cgltf.h"
+
+#include "mesh_format.h"
+#include "mesh_optimize.h"
+
+typedef struct {
+    uint32_t index_start, index_count;
+    uint32_t material;
+} CookSubmesh;
+
+// Source mesh before packing: separate float streams, 32-bit indices
+typedef struct {
+    float* positions;   // 3 per vertex
+    float* texcoords;   // 2 per vertex
+    float* normals;     // 3 per vertex
+    bool has_texcoords, has_normals;
+    uint32_t vertex_count, vertex_capacity;
+    uint32_t* indices;
+    uint32_t index_count, index_capacity;
+    CookSubmesh* submeshes;
+    uint32_t submesh_count, submesh_capacity;
+} CookMesh;
+
+static int grow(void** data, uint32_t* capacity, uint32_t needed, size_t element_size) {
+    if (needed <= *capacity) return 1;
+    uint32_t new_capacity = *capacity ? *capacity : 256;
+    while (new_capacity < needed) new_capacity *= 2;
+    void* grown = realloc(*data, new_capacity * element_size);
+    if (!grown) {
+        printf("Error: Out of memory\n");
+        return 0;
+    }
+    *data = grown;
+    *capacity = new_capacity;
+    return 1;
+}
+
+static void free_cook_mesh(CookMesh* mesh) {
+    free(mesh->positions);
+    free(mesh->texcoords);
+    free(mesh->normals);
+    free(mesh->indices);
+    free(mesh->submeshes);
+    memset(mesh, 0, sizeof(*mesh));
+}
+
+// Append a vertex; streams the mesh does not have are ignored
+static int add_vertex(CookMesh* mesh, const float* position, const float* texcoord, const float* normal) {
+    uint32_t capacity = mesh->vertex_capacity;
+    uint32_t needed = mesh->vertex_count + 1;
+    if (needed > capacity) {
+        uint32_t p_cap = capacity, t_cap = capacity, n_cap = capacity;
+        if (!grow((void**)&mesh->positions, &p_cap, needed, 3 * sizeof(float))) return 0;
+        if (mesh->has_texcoords && !grow((void**)&mesh->texcoords, &t_cap, needed, 2 * sizeof(float))) return 0;
+        if (mesh->has_normals && !grow((void**)&mesh->normals, &n_cap, needed, 3 * sizeof(float))) return 0;
+        mesh->vertex_capacity = p_cap;
+    }
+    uint32_t v = mesh->vertex_count++;
+    memcpy(&mesh->positions[v * 3], position, 3 * sizeof(float));
+    if (mesh->has_texcoords) memcpy(&mesh->texcoords[v * 2], texcoord, 2 * sizeof(float));
+    if (mesh->has_normals) memcpy(&mesh->normals[v * 3], normal, 3 * sizeof(float));
+    return 1;
+}
+
+static int add_index(CookMesh* mesh, uint32_t index) {
+    if (!grow((void**)&mesh->indices, &mesh->index_capacity, mesh->index_count + 1, sizeof(uint32_t))) return 0;
+    mesh->indices[mesh->index_count++] = index;
+    return 1;
+}
+
+// Start a submesh at the current index count (reuses an empty one)
+static int begin_submesh(CookMesh* mesh, uint32_t material) {
+    if (mesh->submesh_count > 0) {
+        CookSubmesh* last = &mesh->submeshes[mesh->submesh_count - 1];
+        if (last->index_count == 0) {
+            last->material = material;
+            return 1;
+        }
+    }
+    if (!grow((void**)&mesh->submeshes, &mesh->submesh_capacity, mesh->submesh_count + 1, sizeof(CookSubmesh))) return 0;
+    mesh->submeshes[mesh->submesh_count++] = (CookSubmesh){ mesh->index_count, 0, material };
+    return 1;
+}
+
+static void end_submesh(CookMesh* mesh) {
+    if (mesh->submesh_count == 0) return;
+    CookSubmesh* last = &mesh->submeshes[mesh->submesh_count - 1];
+    last->index_count = mesh->index_count - last->index_start;
+}
+
+//================================================
+// OBJ
+//================================================
+
+// v/vt/vn triple to output vertex, open addressing
+typedef struct {
+    int p, t, n;
+    uint32_t vertex;
+} ObjCorner;
+
+typedef struct {
+    float* data;
+    uint32_t count, capacity; // In floats
+} FloatList;
+
+static int push_floats(FloatList* list, const float* values, int count) {
+    if (!grow((void**)&list->data, &list->capacity, list->count + count, sizeof(float))) return 0;
+    memcpy(&list->data[list->count], values, count * sizeof(float));
+    list->count += count;
+    return 1;
+}
+
+// OBJ indices are 1-based, negative counts back from the end
+static int resolve_obj_index(int index, uint32_t count) {
+    if (index > 0) return index - 1;
+    if (index < 0) return (int)count + index;
+    return -1;
+}
+
+static uint32_t hash_corner(int p, int t, int n) {
+    uint32_t h = (uint32_t)p * 73856093u ^ (uint32_t)t * 19349663u ^ (uint32_t)n * 83492791u;
+    return h;
+}
+
+typedef struct {
+    ObjCorner* slots;
+    uint32_t capacity, count;
+} CornerMap;
+
+static int corner_map_grow(CornerMap* map) {
+    uint32_t capacity = map->capacity ? map->capacity * 2 : 4096;
+    ObjCorner* slots = (ObjCorner*)malloc(capacity * sizeof(ObjCorner));
+    if (!slots) {
+        printf("Error: Out of memory\n");
+        return 0;
+    }
+    for (uint32_t i = 0; i < capacity; i++) slots[i].p = -1;
+    for (uint32_t i = 0; i < map->capacity; i++) {
+        ObjCorner* corner = &map->slots[i];
+        if (corner->p < 0) continue;
+        uint32_t slot = hash_corner(corner->p, corner->t, corner->n) & (capacity - 1);
+        while (slots[slot].p >= 0) slot = (slot + 1) & (capacity - 1);
+        slots[slot] = *corner;
+    }
+    free(map->slots);
+    map->slots = slots;
+    map->capacity = capacity;
+    return 1;
+}
+
+// Output vertex for a corner, adding it on first use
+static int obj_corner_vertex(CookMesh* mesh, CornerMap* map, int p, int t, int n,
+                             const FloatList* positions, const FloatList* texcoords, const FloatList* normals, uint32_t* vertex) {
+    if ((map->count + 1) * 2 > map->capacity && !corner_map_grow(map)) return 0;
+    uint32_t slot = hash_corner(p, t, n) & (map->capacity - 1);
+    while (map->slots[slot].p >= 0) {
+        ObjCorner* corner = &map->slots[slot];
+        if (corner->p == p && corner->t == t && corner->n == n) {
+            *vertex = corner->vertex;
+            return 1;
+        }
+        slot = (slot + 1) & (map->capacity - 1);
+    }
+    static const float zero[3] = {0.0f, 0.0f, 0.0f};
+    const float* texcoord = t >= 0 ? &texcoords->data[t * 2] : zero;
+    const float* normal = n >= 0 ? &normals->data[n * 3] : zero;
+    if (!add_vertex(mesh, &positions->data[p * 3], texcoord, normal)) return 0;
+    *vertex = mesh->vertex_count - 1;
+    map->slots[slot] = (ObjCorner){ p, t, n, *vertex };
+    map->count++;
+    return 1;
+}
+
+// Parse "p", "p/t", "p//n" or "p/t/n"
+static const char* parse_obj_corner(const char* s, int* p, int* t, int* n) {
+    char* end;
+    *p = (int)strtol(s, &end, 10);
+    *t = 0;
+    *n = 0;
+    if (end == s) return NULL;
+    s = end;
+    if (*s == '/') {
+        s++;
+        if (*s != '/') {
+            *t = (int)strtol(s, &end, 10);
+            s = end;
+        }
+        if (*s == '/') {
+            s++;
+            *n = (int)strtol(s, &end, 10);
+            s = end;
+        }
+    }
+    return s;
+}
+
+// Material names in order of first use; the index is the submesh material
+typedef struct {
+    char (*names)[64];
+    uint32_t count, capacity;
+} NameList;
+
+static int material_index(NameList* list, const char* name, uint32_t* index) {
+    for (uint32_t i = 0; i < list->count; i++) {
+        if (strcmp(list->names[i], name) == 0) {
+            *index = i;
+            return 1;
+        }
+    }
+    if (!grow((void**)&list->names, &list->capacity, list->count + 1, sizeof(list->names[0]))) return 0;
+    snprintf(list->names[list->count], sizeof(list->names[0]), "%s", name);
+    *index = list->count++;
+    return 1;
+}
+
+static int load_obj(const char* path, CookMesh* mesh) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("Error: Failed to open '%s'\n", path);
+        return 0;
+    }
+
+    FloatList positions = {0}, texcoords = {0}, normals = {0};
+    CornerMap corners = {0};
+    NameList materials = {0};
+    int ok = 1;
+    char line[1024];
+
+    // First pass: which streams exist, so add_vertex knows what to store
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, "vt ", 3) == 0) mesh->has_texcoords = true;
+        else if (strncmp(line, "vn ", 3) == 0) mesh->has_normals = true;
+    }
+    rewind(file);
+    ok = begin_submesh(mesh, 0);
+
+    int line_number = 0;
+    while (ok && fgets(line, sizeof(line), file)) {
+        line_number++;
+        float values[3] = {0.0f, 0.0f, 0.0f};
+        if (strncmp(line, "v ", 2) == 0) {
+            sscanf(line + 2, "%f %f %f", &values[0], &values[1], &values[2]);
+            ok = push_floats(&positions, values, 3);
+        } else if (strncmp(line, "vt ", 3) == 0) {
+            sscanf(line + 3, "%f %f", &values[0], &values[1]);
+            ok = push_floats(&texcoords, values, 2);
+        } else if (strncmp(line, "vn ", 3) == 0) {
+            sscanf(line + 3, "%f %f %f", &values[0], &values[1], &values[2]);
+            ok = push_floats(&normals, values, 3);
+        } else if (strncmp(line, "usemtl ", 7) == 0) {
+            char name[64] = {0};
+            sscanf(line + 7, "%63s", name);
+            uint32_t material;
+            ok = material_index(&materials, name, &material);
+            if (ok) {
+                end_submesh(mesh);
+                ok = begin_submesh(mesh, material);
+            }
+        } else if (strncmp(line, "f ", 2) == 0) {
+            // Fan-triangulate the polygon
+            uint32_t first = 0, previous = 0;
+            int corner_count = 0;
+            const char* s = line + 2;
+            while (ok) {
+                while (*s == ' ' || *s == '\t') s++;
+                if (*s == '\0' || *s == '\n' || *s == '\r') break;
+                int p, t, n;
+                s = parse_obj_corner(s, &p, &t, &n);
+                if (!s) break;
+                p = resolve_obj_index(p, positions.count / 3);
+                t = resolve_obj_index(t, texcoords.count / 2);
+                n = resolve_obj_index(n, normals.count / 3);
+                if (p < 0 || p >= (int)(positions.count / 3) || t >= (int)(texcoords.count / 2) || n >= (int)(normals.count / 3)) {
+                    printf("Error: %s:%d: index out of range\n", path, line_number);
+                    ok = 0;
+                    break;
+                }
+                uint32_t vertex;
+                ok = obj_corner_vertex(mesh, &corners, p, t, n, &positions, &texcoords, &normals, &vertex);
+                if (!ok) break;
+                if (corner_count == 0) first = vertex;
+                else if (corner_count >= 2) ok = add_index(mesh, first) && add_index(mesh, previous) && add_index(mesh, vertex);
+                previous = vertex;
+                corner_count++;
+            }
+        }
+    }
+    end_submesh(mesh);
+    // Drop a trailing empty submesh
+    if (mesh->submesh_count > 0 && mesh->submeshes[mesh->submesh_count - 1].index_count == 0) mesh->submesh_count--;
+
+    fclose(file);
+    free(positions.data);
+    free(texcoords.data);
+    free(normals.data);
+    free(corners.slots);
+    free(materials.names);
+    return ok;
+}
+
+//================================================
+// glTF (through cgltf)
+//================================================
+
+static const cgltf_accessor* find_gltf_attribute(const cgltf_primitive* primitive, cgltf_attribute_type type) {
+    for (cgltf_size i = 0; i < primitive->attributes_count; i++) {
+        if (primitive->attributes[i].type == type && primitive->attributes[i].index == 0) return primitive->attributes[i].data;
+    }
+    return NULL;
+}
+
+// Every triangle primitive of every mesh becomes a submesh (vertices in mesh space)
+static int load_gltf(const char* path, CookMesh* mesh) {
+    cgltf_options options;
+    memset(&options, 0, sizeof(options));
+    cgltf_data* data = NULL;
+    if (cgltf_parse_file(&options, path, &data) != cgltf_result_success || cgltf_load_buffers(&options, data, path) != cgltf_result_success) {
+        printf("Error: Failed to load glTF '%s'\n", path);
+        if (data) cgltf_free(data);
+        return 0;
+    }
+
+    // A stream is kept if any primitive has it
+    for (cgltf_size m = 0; m < data->meshes_count; m++) {
+        for (cgltf_size p = 0; p < data->meshes[m].primitives_count; p++) {
+            const cgltf_primitive* primitive = &data->meshes[m].primitives[p];
+            if (find_gltf_attribute(primitive, cgltf_attribute_type_texcoord)) mesh->has_texcoords = true;
+            if (find_gltf_attribute(primitive, cgltf_attribute_type_normal)) mesh->has_normals = true;
+        }
+    }
+
+    int ok = 1;
+    for (cgltf_size m = 0; ok && m < data->meshes_count; m++) {
+        for (cgltf_size p = 0; ok && p < data->meshes[m].primitives_count; p++) {
+            const cgltf_primitive* primitive = &data->meshes[m].primitives[p];
+            if (primitive->type != cgltf_primitive_type_triangles) continue;
+            const cgltf_accessor* position = find_gltf_attribute(primitive, cgltf_attribute_type_position);
+            if (!position) continue;
+            const cgltf_accessor* texcoord = find_gltf_attribute(primitive, cgltf_attribute_type_texcoord);
+            const cgltf_accessor* normal = find_gltf_attribute(primitive, cgltf_attribute_type_normal);
+
+            uint32_t material = primitive->material ? (uint32_t)(primitive->material - data->materials) : 0;
+            ok = begin_submesh(mesh, material);
+            uint32_t base = mesh->vertex_count;
+            for (cgltf_size v = 0; ok && v < position->count; v++) {
+                float xyz[3] = {0.0f, 0.0f, 0.0f}, uv[2] = {0.0f, 0.0f}, n[3] = {0.0f, 0.0f, 0.0f};
+                cgltf_accessor_read_float(position, v, xyz, 3);
+                if (texcoord) cgltf_accessor_read_float(texcoord, v, uv, 2);
+                if (normal) cgltf_accessor_read_float(normal, v, n, 3);
+                ok = add_vertex(mesh, xyz, uv, n);
+            }
+            if (primitive->indices) {
+                for (cgltf_size i = 0; ok && i < primitive->indices->count; i++) {
+                    ok = add_index(mesh, base + (uint32_t)cgltf_accessor_read_index(primitive->indices, i));
+                }
+            } else {
+                for (cgltf_size i = 0; ok && i < position->count; i++) ok = add_index(mesh, base + (uint32_t)i);
+            }
+            end_submesh(mesh);
+        }
+    }
+    cgltf_free(data);
+    return ok;
+}
+
+//================================================
+// Writer
+//================================================
+
+static uint32_t align_offset(uint32_t offset) {
+    return (offset + MESH_ALIGN - 1) & ~(uint32_t)(MESH_ALIGN - 1);
+}
+
+static void compute_bounds(const CookMesh* mesh, uint32_t index_start, uint32_t index_count, float* bounds_min, float* bounds_max) {
+    for (int c = 0; c < 3; c++) {
+        bounds_min[c] = FLT_MAX;
+        bounds_max[c] = -FLT_MAX;
+    }
+    for (uint32_t i = index_start; i < index_start + index_count; i++) {
+        const float* p = &mesh->positions[mesh->indices[i] * 3];
+        for (int c = 0; c < 3; c++) {
+            if (p[c] < bounds_min[c]) bounds_min[c] = p[c];
+            if (p[c] > bounds_max[c]) bounds_max[c] = p[c];
+        }
+    }
+    if (index_count == 0) {
+        for (int c = 0; c < 3; c++) bounds_min[c] = bounds_max[c] = 0.0f;
+    }
+}
+
+static int write_padding(FILE* file, long target) {
+    static const unsigned char zeros[MESH_ALIGN] = {0};
+    long position = ftell(file);
+    return position <= target && fwrite(zeros, 1, (size_t)(target - position), file) == (size_t)(target - position);
+}
+
+//================================================
+// Vertex encoding
+//================================================
+
+// Output formats, chosen per mesh on the command line
+typedef struct {
+    uint32_t position_format;   // MESH_FORMAT_FLOAT3, HALF4 or SNORM16x4
+    uint32_t texcoord_format;   // MESH_FORMAT_FLOAT2, HALF2 or UNORM16x2
+    uint32_t normal_format;     // MESH_FORMAT_FLOAT3 or SNORM10x3
+    bool index16;               // 16-bit indices when the vertex count allows
+    float tolerance;            // Max decode error: positions relative to the mesh size, others absolute
+    bool optimize;              // Reorder indices and vertices (see optimize_cook_mesh)
+    uint32_t cache_size;        // FIFO size the vertex cache order targets
+    float overdraw_threshold;   // ACMR a cluster may lose to overdraw sorting, 0 to skip it
+} CookOptions;
+
+static float clampf(float value, float lo, float hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+// Round to nearest even; overflow becomes infinity (caught by the verification)
+static uint16_t float_to_half(float value) {
+    union { float f; uint32_t u; } bits = { value };
+    uint32_t sign = (bits.u >> 16) & 0x8000;
+    uint32_t raw_exponent = (bits.u >> 23) & 0xFF;
+    int32_t exponent = (int32_t)raw_exponent - 127 + 15;
+    uint32_t mantissa = bits.u & 0x7FFFFF;
+    if (raw_exponent == 0xFF) return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    if (exponent >= 31) return (uint16_t)(sign | 0x7C00);
+    if (exponent <= 0) {
+        // Subnormal half
+        if (exponent < -10) return (uint16_t)sign;
+        mantissa |= 0x800000;
+        uint32_t shift = (uint32_t)(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) half++;
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++; // A carry into the exponent is still correct
+    return (uint16_t)half;
+}
+
+static float half_to_float(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    if (exponent == 0) {
+        float value = ldexpf((float)mantissa, -24);
+        return sign ? -value : value;
+    }
+    union { uint32_t u; float f; } bits;
+    if (exponent == 31) bits.u = sign | 0x7F800000 | (mantissa << 13);
+    else bits.u = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    return bits.f;
+}
+
+static int16_t encode_snorm16(float value) {
+    return (int16_t)lroundf(clampf(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+static float decode_snorm16(int16_t value) {
+    return fmaxf((float)value / 32767.0f, -1.0f);
+}
+
+// Encode components of src into one vertex attribute. scale/offset only apply to
+// SNORM16x4 positions: stored = (value - offset) / scale.
+static void encode_attribute(uint32_t format, const float* src, int components, const float* scale, const float* offset, unsigned char* dst) {
+    float v[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    memcpy(v, src, components * sizeof(float));
+    switch (format) {
+        case MESH_FORMAT_FLOAT2:
+        case MESH_FORMAT_FLOAT3:
+        case MESH_FORMAT_FLOAT4:
+            memcpy(dst, v, mesh_format_size(format));
+            break;
+        case MESH_FORMAT_HALF2:
+        case MESH_FORMAT_HALF4: {
+            uint16_t h[4];
+            for (int c = 0; c < 4; c++) h[c] = float_to_half(v[c]);
+            memcpy(dst, h, mesh_format_size(format));
+            break;
+        }
+        case MESH_FORMAT_SNORM16x4: {
+            int16_t q[4];
+            for (int c = 0; c < 3; c++) q[c] = encode_snorm16((v[c] - offset[c]) / scale[c]);
+            q[3] = 32767;
+            memcpy(dst, q, sizeof(q));
+            break;
+        }
+        case MESH_FORMAT_UNORM16x2: {
+            uint16_t q[2];
+            for (int c = 0; c < 2; c++) q[c] = (uint16_t)lroundf(clampf(v[c], 0.0f, 1.0f) * 65535.0f);
+            memcpy(dst, q, sizeof(q));
+            break;
+        }
+        case MESH_FORMAT_SNORM10x3: {
+            uint32_t packed = 0;
+            for (int c = 0; c < 3; c++) {
+                int32_t q = (int32_t)lroundf(clampf(v[c], -1.0f, 1.0f) * 511.0f);
+                packed |= ((uint32_t)q & 0x3FF) << (10 * c);
+            }
+            memcpy(dst, &packed, sizeof(packed));
+            break;
+        }
+    }
+}
+
+// Inverse of encode_attribute, as the GL would read it (GL 4.2+ snorm rule)
+static void decode_attribute(uint32_t format, const unsigned char* src, const float* scale, const float* offset, float* out) {
+    switch (format) {
+        case MESH_FORMAT_FLOAT2:
+        case MESH_FORMAT_FLOAT3:
+        case MESH_FORMAT_FLOAT4:
+            memcpy(out, src, mesh_format_size(format));
+            break;
+        case MESH_FORMAT_HALF2:
+        case MESH_FORMAT_HALF4: {
+            uint16_t h[4];
+            memcpy(h, src, mesh_format_size(format));
+            for (uint32_t c = 0; c < mesh_format_size(format) / 2; c++) out[c] = half_to_float(h[c]);
+            break;
+        }
+        case MESH_FORMAT_SNORM16x4: {
+            int16_t q[4];
+            memcpy(q, src, sizeof(q));
+            for (int c = 0; c < 3; c++) out[c] = offset[c] + scale[c] * decode_snorm16(q[c]);
+            break;
+        }
+        case MESH_FORMAT_UNORM16x2: {
+            uint16_t q[2];
+            memcpy(q, src, sizeof(q));
+            for (int c = 0; c < 2; c++) out[c] = (float)q[c] / 65535.0f;
+            break;
+        }
+        case MESH_FORMAT_SNORM10x3: {
+            uint32_t packed;
+            memcpy(&packed, src, sizeof(packed));
+            for (int c = 0; c < 3; c++) {
+                int32_t q = (int32_t)(packed << (22 - 10 * c)) >> 22; // Sign-extend 10 bits
+                out[c] = fmaxf((float)q / 511.0f, -1.0f);
+            }
+            break;
+        }
+    }
+}
+
+static const char* format_name(uint32_t format) {
+    static const char* names[MESH_FORMAT_COUNT] = {
+        "float2", "float3", "float4", "half2", "half4", "snorm16x4", "unorm16x2", "snorm10x3"
+    };
+    return format < MESH_FORMAT_COUNT ? names[format] : "?";
+}
+
+// Unit-length normals, so SNORM10x3 keeps its full range
+static void normalize_normals(CookMesh* mesh) {
+    for (uint32_t v = 0; v < mesh->vertex_count; v++) {
+        float* n = &mesh->normals[v * 3];
+        float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0.0f) {
+            n[0] /= length;
+            n[1] /= length;
+            n[2] /= length;
+        }
+    }
+}
+
+// Decode every vertex and compare with the source; 0 if an attribute is off by more than the tolerance
+static int verify_vertices(const CookMesh* mesh, const unsigned char* vertices, uint32_t stride, const MeshAttribute* attributes,
+                           uint32_t attribute_count, const MeshFileHeader* header, float tolerance) {
+    float extent = 0.0f;
+    for (int c = 0; c < 3; c++) extent = fmaxf(extent, header->bounds_max[c] - header->bounds_min[c]);
+    if (extent == 0.0f) extent = 1.0f;
+
+    int ok = 1;
+    for (uint32_t a = 0; a < attribute_count; a++) {
+        const MeshAttribute* attribute = &attributes[a];
+        const float* source = attribute->semantic == MESH_ATTRIB_POSITION ? mesh->positions
+                            : attribute->semantic == MESH_ATTRIB_TEXCOORD ? mesh->texcoords : mesh->normals;
+        int components = attribute->semantic == MESH_ATTRIB_TEXCOORD ? 2 : 3;
+        float max_error = 0.0f;
+        for (uint32_t v = 0; v < mesh->vertex_count; v++) {
+            float decoded[4];
+            decode_attribute(attribute->format, vertices + (size_t)v * stride + attribute->offset, header->position_scale, header->position_offset, decoded);
+            for (int c = 0; c < components; c++) {
+                float error = fabsf(decoded[c] - source[v * components + c]);
+                if (!(error == error)) error = INFINITY; // NaN
+                max_error = fmaxf(max_error, error);
+            }
+        }
+        float relative = attribute->semantic == MESH_ATTRIB_POSITION ? max_error / extent : max_error;
+        const char* names[] = { "position", "texcoord", "normal", "color" };
+        printf("  %-8s %-9s max error %g%s\n", names[attribute->semantic], format_name(attribute->format), relative,
+               attribute->semantic == MESH_ATTRIB_POSITION ? " (of mesh size)" : "");
+        if (relative > tolerance) {
+            printf("Error: %s error %g is over the tolerance %g, use a wider format\n", names[attribute->semantic], relative, tolerance);
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+//================================================
+// Reordering
+//================================================
+
+static void print_cache_stats(const char* label, const CookMesh* mesh, uint32_t cache_size) {
+    MeshCacheStats stats = analyze_vertex_cache(mesh->indices, mesh->index_count, mesh->vertex_count, cache_size);
+    printf("  %-6s ACMR %.3f  ATVR %.3f  (FIFO %u)\n", label, stats.acmr, stats.atvr, cache_size);
+}
+
+// Per submesh: Tipsify for the post-transform cache, then overdraw ordering of its
+// clusters. Then one pass over all indices renumbers the vertices in first-use order
+// for the pre-transform (fetch) cache; unused vertices are dropped.
+static int optimize_cook_mesh(CookMesh* mesh, const CookOptions* options) {
+    print_cache_stats("before", mesh, options->cache_size);
+
+    uint32_t* reordered = (uint32_t*)malloc((mesh->index_count + 1) * sizeof(uint32_t));
+    uint32_t* clusters = (uint32_t*)malloc((mesh->index_count / 3 + 1) * sizeof(uint32_t));
+    uint32_t* remap = (uint32_t*)malloc((mesh->vertex_count + 1) * sizeof(uint32_t));
+    float* positions = (float*)malloc((mesh->vertex_count * 3 + 1) * sizeof(float));
+    float* texcoords = mesh->has_texcoords ? (float*)malloc((mesh->vertex_count * 2 + 1) * sizeof(float)) : NULL;
+    float* normals = mesh->has_normals ? (float*)malloc((mesh->vertex_count * 3 + 1) * sizeof(float)) : NULL;
+    int ok = reordered && clusters && remap && positions && (texcoords || !mesh->has_texcoords) && (normals || !mesh->has_normals);
+    if (!ok) printf("Error: Out of memory\n");
+
+    for (uint32_t s = 0; ok && s < mesh->submesh_count; s++) {
+        uint32_t* indices = mesh->indices + mesh->submeshes[s].index_start;
+        uint32_t index_count = mesh->submeshes[s].index_count;
+        uint32_t cluster_count = 0;
+        ok = optimize_vertex_cache(reordered, indices, index_count, mesh->vertex_count, options->cache_size, clusters, &cluster_count);
+        if (ok) memcpy(indices, reordered, index_count / 3 * 3 * sizeof(uint32_t));
+        if (ok && options->overdraw_threshold > 0.0f) {
+            ok = optimize_overdraw(indices, index_count, mesh->positions, mesh->vertex_count, clusters, cluster_count,
+                                   options->cache_size, options->overdraw_threshold);
+        }
+    }
+
+    if (ok) {
+        uint32_t used = optimize_vertex_fetch_remap(remap, mesh->indices, mesh->index_count, mesh->vertex_count);
+        for (uint32_t v = 0; v < mesh->vertex_count; v++) {
+            uint32_t target = remap[v];
+            if (target == 0xFFFFFFFFu) continue;
+            memcpy(&positions[target * 3], &mesh->positions[v * 3], 3 * sizeof(float));
+            if (texcoords) memcpy(&texcoords[target * 2], &mesh->texcoords[v * 2], 2 * sizeof(float));
+            if (normals) memcpy(&normals[target * 3], &mesh->normals[v * 3], 3 * sizeof(float));
+        }
+        if (used < mesh->vertex_count) printf("  dropped %u unused vertices\n", mesh->vertex_count - used);
+
+        // Swap the new streams in; the capacity only matters while parsing
+        free(mesh->positions);
+        free(mesh->texcoords);
+        free(mesh->normals);
+        mesh->positions = positions;
+        mesh->texcoords = texcoords;
+        mesh->normals = normals;
+        mesh->vertex_count = used;
+        mesh->vertex_capacity = used;
+        positions = texcoords = normals = NULL;
+
+        print_cache_stats("after", mesh, options->cache_size);
+    }
+
+    free(reordered);
+    free(clusters);
+    free(remap);
+    free(positions);
+    free(texcoords);
+    free(normals);
+    return ok;
+}
+
+static int write_mesh(const CookMesh* mesh, const CookOptions* options, const char* path) {
+    uint32_t texcoord_format = options->texcoord_format;
+    if (mesh->has_texcoords && texcoord_format == MESH_FORMAT_UNORM16x2) {
+        // unorm16 only covers [0, 1]; tiled UVs fall back to half
+        for (uint32_t i = 0; i < mesh->vertex_count * 2; i++) {
+            if (mesh->texcoords[i] < 0.0f || mesh->texcoords[i] > 1.0f) {
+                printf("Texcoords outside [0, 1], using half2 instead of unorm16x2\n");
+                texcoord_format = MESH_FORMAT_HALF2;
+                break;
+            }
+        }
+    }
+
+    // Interleave the streams: position, then texcoord and normal if present
+    MeshAttribute attributes[MESH_ATTRIB_COUNT];
+    uint32_t attribute_count = 0, stride = 0;
+    attributes[attribute_count++] = (MeshAttribute){ MESH_ATTRIB_POSITION, options->position_format, stride, 0 };
+    stride += mesh_format_size(options->position_format);
+    if (mesh->has_texcoords) {
+        attributes[attribute_count++] = (MeshAttribute){ MESH_ATTRIB_TEXCOORD, texcoord_format, stride, 0 };
+        stride += mesh_format_size(texcoord_format);
+    }
+    if (mesh->has_normals) {
+        attributes[attribute_count++] = (MeshAttribute){ MESH_ATTRIB_NORMAL, options->normal_format, stride, 0 };
+        stride += mesh_format_size(options->normal_format);
+    }
+
+    MeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MESH_MAGIC;
+    header.version = MESH_VERSION;
+    header.vertex_count = mesh->vertex_count;
+    header.index_count = mesh->index_count;
+    header.vertex_stride = stride;
+    header.index_size = options->index16 && mesh->vertex_count <= 65536 ? 2 : 4;
+    header.attribute_count = attribute_count;
+    header.submesh_count = mesh->submesh_count;
+    header.attribute_offset = align_offset(sizeof(MeshFileHeader));
+    header.submesh_offset = align_offset(header.attribute_offset + attribute_count * sizeof(MeshAttribute));
+    header.vertex_offset = align_offset(header.submesh_offset + mesh->submesh_count * sizeof(MeshSubmesh));
+    header.index_offset = align_offset(header.vertex_offset + mesh->vertex_count * stride);
+    compute_bounds(mesh, 0, mesh->index_count, header.bounds_min, header.bounds_max);
+    // One scale for all axes keeps the dequantize matrix uniform, so shaders that build a
+    // normal matrix from the model matrix still get correct normals
+    float half_extent = 0.0f;
+    for (int c = 0; c < 3; c++) half_extent = fmaxf(half_extent, 0.5f * (header.bounds_max[c] - header.bounds_min[c]));
+    for (int c = 0; c < 3; c++) {
+        header.position_scale[c] = 1.0f;
+        header.position_offset[c] = 0.0f;
+        if (options->position_format == MESH_FORMAT_SNORM16x4) {
+            header.position_offset[c] = 0.5f * (header.bounds_max[c] + header.bounds_min[c]);
+            header.position_scale[c] = half_extent > 0.0f ? half_extent : 1.0f;
+        }
+    }
+
+    unsigned char* vertices = (unsigned char*)malloc((size_t)mesh->vertex_count * stride + 1);
+    unsigned char* indices = (unsigned char*)malloc((size_t)mesh->index_count * header.index_size + 1);
+    MeshSubmesh* submeshes = (MeshSubmesh*)calloc(mesh->submesh_count + 1, sizeof(MeshSubmesh));
+    if (!vertices || !indices || !submeshes) {
+        printf("Error: Out of memory\n");
+        free(vertices);
+        free(indices);
+        free(submeshes);
+        return 0;
+    }
+    for (uint32_t v = 0; v < mesh->vertex_count; v++) {
+        unsigned char* vertex = vertices + (size_t)v * stride;
+        for (uint32_t a = 0; a < attribute_count; a++) {
+            const MeshAttribute* attribute = &attributes[a];
+            if (attribute->semantic == MESH_ATTRIB_POSITION) {
+                encode_attribute(attribute->format, &mesh->positions[v * 3], 3, header.position_scale, header.position_offset, vertex + attribute->offset);
+            } else if (attribute->semantic == MESH_ATTRIB_TEXCOORD) {
+                encode_attribute(attribute->format, &mesh->texcoords[v * 2], 2, NULL, NULL, vertex + attribute->offset);
+            } else {
+                encode_attribute(attribute->format, &mesh->normals[v * 3], 3, NULL, NULL, vertex + attribute->offset);
+            }
+        }
+    }
+    for (uint32_t i = 0; i < mesh->index_count; i++) {
+        if (header.index_size == 2) ((uint16_t*)indices)[i] = (uint16_t)mesh->indices[i];
+        else ((uint32_t*)indices)[i] = mesh->indices[i];
+    }
+    for (uint32_t s = 0; s < mesh->submesh_count; s++) {
+        submeshes[s].index_start = mesh->submeshes[s].index_start;
+        submeshes[s].index_count = mesh->submeshes[s].index_count;
+        submeshes[s].material = mesh->submeshes[s].material;
+        compute_bounds(mesh, submeshes[s].index_start, submeshes[s].index_count, submeshes[s].bounds_min, submeshes[s].bounds_max);
+    }
+
+    int ok = verify_vertices(mesh, vertices, stride, attributes, attribute_count, &header, options->tolerance);
+    FILE* file = ok ? fopen(path, "wb") : NULL;
+    if (!ok) {
+        // Already reported
+    } else if (file) {
+        ok = fwrite(&header, sizeof(header), 1, file) == 1
+          && write_padding(file, header.attribute_offset)
+          && fwrite(attributes, sizeof(MeshAttribute), attribute_count, file) == attribute_count
+          && write_padding(file, header.submesh_offset)
+          && fwrite(submeshes, sizeof(MeshSubmesh), mesh->submesh_count, file) == mesh->submesh_count
+          && write_padding(file, header.vertex_offset)
+          && fwrite(vertices, stride, mesh->vertex_count, file) == mesh->vertex_count
+          && write_padding(file, header.index_offset)
+          && fwrite(indices, header.index_size, mesh->index_count, file) == mesh->index_count;
+        ok = (fclose(file) == 0) && ok;
+        if (!ok) printf("Error: Failed to write '%s'\n", path);
+    } else {
+        printf("Error: Failed to open '%s'\n", path);
+        ok = 0;
+    }
+    if (ok) printf("  %u bytes per vertex, %u-bit indices\n", stride, header.index_size * 8);
+
+    free(vertices);
+    free(indices);
+    free(submeshes);
+    return ok;
+}
+
+static bool has_extension(const char* path, const char* extension) {
+    size_t length = strlen(path), ext_length = strlen(extension);
+    if (length < ext_length) return false;
+    const char* a = path + length - ext_length;
+    for (size_t i = 0; i < ext_length; i++) {
+        char c = a[i];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (c != extension[i]) return false;
+    }
+    return true;
+}
+
+static void print_usage(const char* program) {
+    printf("usage: %s [options] input.obj|input.gltf|input.glb output.mesh\n"
+           "  --position float|half|snorm16   (default snorm16)\n"
+           "  --texcoord float|half|unorm16   (default unorm16, half if outside [0, 1])\n"
+           "  --normal float|packed           (default packed, GL_INT_2_10_10_10_REV)\n"
+           "  --index32                       always 32-bit indices (default: 16-bit when they fit)\n"
+           "  --float                         uncompressed: float attributes, 32-bit indices\n"
+           "  --tolerance <t>                 max decode error (default 0.002)\n"
+           "  --no-optimize                   keep the source index and vertex order\n"
+           "  --cache-size <n>                vertex cache size to optimize for (default 16)\n"
+           "  --overdraw <t>                  overdraw cluster threshold, 0 to skip (default 1.05)\n", program);
+}
+
+static int parse_format(const char* value, const char* const* names, const uint32_t* formats, int count, uint32_t* format) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(value, names[i]) == 0) {
+            *format = formats[i];
+            return 1;
+        }
+    }
+    printf("Error: Unknown format '%s'\n", value);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    CookOptions options = {
+        .position_format = MESH_FORMAT_SNORM16x4,
+        .texcoord_format = MESH_FORMAT_UNORM16x2,
+        .normal_format = MESH_FORMAT_SNORM10x3,
+        .index16 = true,
+        .tolerance = 0.002f,
+        .optimize = true,
+        .cache_size = 16,
+        .overdraw_threshold = 1.05f
+    };
+    static const char* position_names[] = { "float", "half", "snorm16" };
+    static const uint32_t position_formats[] = { MESH_FORMAT_FLOAT3, MESH_FORMAT_HALF4, MESH_FORMAT_SNORM16x4 };
+    static const char* texcoord_names[] = { "float", "half", "unorm16" };
+    static const uint32_t texcoord_formats[] = { MESH_FORMAT_FLOAT2, MESH_FORMAT_HALF2, MESH_FORMAT_UNORM16x2 };
+    static const char* normal_names[] = { "float", "packed" };
+    static const uint32_t normal_formats[] = { MESH_FORMAT_FLOAT3, MESH_FORMAT_SNORM10x3 };
+
+    const char* input = NULL;
+    const char* output = NULL;
+    int ok = 1;
+    for (int i = 1; ok && i < argc; i++) {
+        const char* arg = argv[i];
+        int has_value = i + 1 < argc;
+        if (strcmp(arg, "--position") == 0 && has_value) ok = parse_format(argv[++i], position_names, position_formats, 3, &options.position_format);
+        else if (strcmp(arg, "--texcoord") == 0 && has_value) ok = parse_format(argv[++i], texcoord_names, texcoord_formats, 3, &options.texcoord_format);
+        else if (strcmp(arg, "--normal") == 0 && has_value) ok = parse_format(argv[++i], normal_names, normal_formats, 2, &options.normal_format);
+        else if (strcmp(arg, "--tolerance") == 0 && has_value) options.tolerance = (float)atof(argv[++i]);
+        else if (strcmp(arg, "--index32") == 0) options.index16 = false;
+        else if (strcmp(arg, "--no-optimize") == 0) options.optimize = false;
+        else if (strcmp(arg, "--cache-size") == 0 && has_value) options.cache_size = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(arg, "--overdraw") == 0 && has_value) options.overdraw_threshold = (float)atof(argv[++i]);
+        else if (strcmp(arg, "--float") == 0) {
+            options.position_format = MESH_FORMAT_FLOAT3;
+            options.texcoord_format = MESH_FORMAT_FLOAT2;
+            options.normal_format = MESH_FORMAT_FLOAT3;
+            options.index16 = false;
+        }
+        else if (arg[0] == '-' && arg[1] == '-') ok = 0;
+        else if (!input) input = arg;
+        else if (!output) output = arg;
+        else ok = 0;
+    }
+    if (options.cache_size < 3) ok = 0;
+    if (!ok || !input || !output) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    CookMesh mesh;
+    memset(&mesh, 0, sizeof(mesh));
+    if (has_extension(input, ".obj")) {
+        ok = load_obj(input, &mesh);
+    } else if (has_extension(input, ".gltf") || has_extension(input, ".glb")) {
+        ok = load_gltf(input, &mesh);
+    } else {
+        printf("Error: Unknown input format '%s'\n", input);
+        ok = 0;
+    }
+    if (ok && mesh.index_count == 0) {
+        printf("Error: No triangles in '%s'\n", input);
+        ok = 0;
+    }
+    if (ok && options.optimize) ok = optimize_cook_mesh(&mesh, &options);
+    if (ok && mesh.has_normals) normalize_normals(&mesh);
+    if (ok) ok = write_mesh(&mesh, &options, output);
+    if (ok) {
+        printf("%s: %u vertices, %u indices, %u submeshes\n", output, mesh.vertex_count, mesh.index_count, mesh.submesh_count);
+    }
+    free_cook_mesh(&mesh);
+    return ok ? 0 : 1;
+}
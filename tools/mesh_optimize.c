@@ -0,0 +1,333 @@
+// mesh_optimize.c
+// Offline index/vertex reordering used by mesh_cooker (see mesh_optimize.h).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "mesh_optimize.h"
+
+#define NO_VERTEX 0xFFFFFFFFu
+
+// FIFO cache model shared by every function here: a vertex is cached while fewer than
+// cache_size misses happened since it was loaded. time starts past cache_size so the
+// zeroed timestamps all miss.
+typedef struct {
+    uint32_t* timestamps;
+    uint32_t time;
+    uint32_t size;
+} CacheModel;
+
+static int init_cache_model(CacheModel* cache, uint32_t vertex_count, uint32_t cache_size) {
+    cache->timestamps = (uint32_t*)calloc(vertex_count + 1, sizeof(uint32_t));
+    cache->time = cache_size + 1;
+    cache->size = cache_size;
+    if (!cache->timestamps) printf("Error: Out of memory\n");
+    return cache->timestamps != NULL;
+}
+
+// Returns 1 on a miss
+static int touch_cache(CacheModel* cache, uint32_t vertex) {
+    if (cache->time - cache->timestamps[vertex] <= cache->size) return 0;
+    cache->timestamps[vertex] = cache->time++;
+    return 1;
+}
+
+// Everything currently cached counts as evicted
+static void flush_cache(CacheModel* cache) {
+    cache->time += cache->size + 1;
+}
+
+MeshCacheStats analyze_vertex_cache(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count, uint32_t cache_size) {
+    MeshCacheStats stats = {0};
+    CacheModel cache;
+    unsigned char* used = (unsigned char*)calloc(vertex_count + 1, 1);
+    if (!used || !init_cache_model(&cache, vertex_count, cache_size)) {
+        free(used);
+        return stats;
+    }
+
+    uint32_t misses = 0, used_count = 0;
+    for (uint32_t i = 0; i < index_count; i++) {
+        uint32_t vertex = indices[i];
+        misses += touch_cache(&cache, vertex);
+        if (!used[vertex]) {
+            used[vertex] = 1;
+            used_count++;
+        }
+    }
+    if (index_count >= 3) stats.acmr = (float)misses / (float)(index_count / 3);
+    if (used_count) stats.atvr = (float)misses / (float)used_count;
+
+    free(cache.timestamps);
+    free(used);
+    return stats;
+}
+
+//================================================
+// Tipsify
+//================================================
+
+typedef struct {
+    uint32_t* offsets;      // vertex_count + 1, triangles of vertex v are triangles[offsets[v]..offsets[v+1]]
+    uint32_t* triangles;
+    uint32_t* live;         // Corners not emitted yet, per vertex
+} Adjacency;
+
+static void free_adjacency(Adjacency* adjacency) {
+    free(adjacency->offsets);
+    free(adjacency->triangles);
+    free(adjacency->live);
+}
+
+static int build_adjacency(Adjacency* adjacency, const uint32_t* indices, uint32_t index_count, uint32_t vertex_count) {
+    adjacency->offsets = (uint32_t*)calloc(vertex_count + 1, sizeof(uint32_t));
+    adjacency->triangles = (uint32_t*)malloc((index_count + 1) * sizeof(uint32_t));
+    adjacency->live = (uint32_t*)calloc(vertex_count + 1, sizeof(uint32_t));
+    if (!adjacency->offsets || !adjacency->triangles || !adjacency->live) {
+        printf("Error: Out of memory\n");
+        free_adjacency(adjacency);
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < index_count; i++) adjacency->live[indices[i]]++;
+    uint32_t offset = 0;
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        adjacency->offsets[v] = offset;
+        offset += adjacency->live[v];
+    }
+    adjacency->offsets[vertex_count] = offset;
+
+    // Fill with a running cursor per vertex, then shift the offsets back
+    for (uint32_t i = 0; i < index_count; i++) {
+        adjacency->triangles[adjacency->offsets[indices[i]]++] = i / 3;
+    }
+    for (uint32_t v = vertex_count; v > 0; v--) adjacency->offsets[v] = adjacency->offsets[v - 1];
+    adjacency->offsets[0] = 0;
+    return 1;
+}
+
+// Most recently emitted vertex that still has triangles, else the next one in index order
+static uint32_t skip_dead_end(const uint32_t* live, const uint32_t* dead_ends, uint32_t* dead_end_count,
+                              uint32_t* cursor, uint32_t vertex_count) {
+    while (*dead_end_count > 0) {
+        uint32_t vertex = dead_ends[--*dead_end_count];
+        if (live[vertex] > 0) return vertex;
+    }
+    while (*cursor < vertex_count) {
+        uint32_t vertex = (*cursor)++;
+        if (live[vertex] > 0) return vertex;
+    }
+    return NO_VERTEX;
+}
+
+int optimize_vertex_cache(uint32_t* destination, const uint32_t* indices, uint32_t index_count, uint32_t vertex_count,
+                          uint32_t cache_size, uint32_t* clusters, uint32_t* cluster_count) {
+    uint32_t triangle_count = index_count / 3;
+    if (cluster_count) *cluster_count = 0;
+    if (triangle_count == 0) return 1;
+
+    Adjacency adjacency;
+    CacheModel cache;
+    if (!build_adjacency(&adjacency, indices, triangle_count * 3, vertex_count)) return 0;
+    unsigned char* emitted = (unsigned char*)calloc(triangle_count, 1);
+    uint32_t* dead_ends = (uint32_t*)malloc(triangle_count * 3 * sizeof(uint32_t));
+    uint32_t* candidates = (uint32_t*)malloc(triangle_count * 3 * sizeof(uint32_t));
+    if (!emitted || !dead_ends || !candidates || !init_cache_model(&cache, vertex_count, cache_size)) {
+        if (!emitted || !dead_ends || !candidates) printf("Error: Out of memory\n");
+        free(emitted);
+        free(dead_ends);
+        free(candidates);
+        free_adjacency(&adjacency);
+        return 0;
+    }
+
+    uint32_t output = 0, dead_end_count = 0, cursor = 0;
+    uint32_t fan = skip_dead_end(adjacency.live, dead_ends, &dead_end_count, &cursor, vertex_count);
+    if (clusters) clusters[(*cluster_count)++] = 0;
+
+    while (fan != NO_VERTEX) {
+        // Emit every remaining triangle around the fanning vertex
+        uint32_t candidate_count = 0;
+        for (uint32_t t = adjacency.offsets[fan]; t < adjacency.offsets[fan + 1]; t++) {
+            uint32_t triangle = adjacency.triangles[t];
+            if (emitted[triangle]) continue;
+            emitted[triangle] = 1;
+            for (int corner = 0; corner < 3; corner++) {
+                uint32_t vertex = indices[triangle * 3 + corner];
+                destination[output++] = vertex;
+                dead_ends[dead_end_count++] = vertex;
+                candidates[candidate_count++] = vertex;
+                adjacency.live[vertex]--;
+                touch_cache(&cache, vertex);
+            }
+        }
+
+        // Next fan: the oldest candidate that is still cached after emitting its triangles
+        uint32_t next = NO_VERTEX;
+        int64_t best_priority = -1;
+        for (uint32_t c = 0; c < candidate_count; c++) {
+            uint32_t vertex = candidates[c];
+            if (adjacency.live[vertex] == 0) continue;
+            int64_t priority = 0;
+            uint32_t age = cache.time - cache.timestamps[vertex];
+            if (age + 2 * adjacency.live[vertex] <= cache_size) priority = age;
+            if (priority > best_priority) {
+                best_priority = priority;
+                next = vertex;
+            }
+        }
+        if (next == NO_VERTEX) {
+            next = skip_dead_end(adjacency.live, dead_ends, &dead_end_count, &cursor, vertex_count);
+            if (clusters && next != NO_VERTEX && output / 3 < triangle_count) clusters[(*cluster_count)++] = output / 3;
+        }
+        fan = next;
+    }
+
+    free(cache.timestamps);
+    free(emitted);
+    free(dead_ends);
+    free(candidates);
+    free_adjacency(&adjacency);
+    return 1;
+}
+
+//================================================
+// Overdraw
+//================================================
+
+typedef struct {
+    uint32_t start, count;  // Triangles
+    float sort_key;
+} TriangleCluster;
+
+static int compare_clusters(const void* a, const void* b) {
+    const TriangleCluster* ca = (const TriangleCluster*)a;
+    const TriangleCluster* cb = (const TriangleCluster*)b;
+    if (ca->sort_key != cb->sort_key) return ca->sort_key > cb->sort_key ? -1 : 1;
+    return ca->start < cb->start ? -1 : (ca->start > cb->start);
+}
+
+static void triangle_centroid_normal(const uint32_t* triangle, const float* positions, float* centroid, float* normal) {
+    const float* a = &positions[triangle[0] * 3];
+    const float* b = &positions[triangle[1] * 3];
+    const float* c = &positions[triangle[2] * 3];
+    float ab[3], ac[3];
+    for (int k = 0; k < 3; k++) {
+        ab[k] = b[k] - a[k];
+        ac[k] = c[k] - a[k];
+        centroid[k] = (a[k] + b[k] + c[k]) / 3.0f;
+    }
+    // Length is twice the area, so sums are area weighted
+    normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+    normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+    normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+}
+
+int optimize_overdraw(uint32_t* indices, uint32_t index_count, const float* positions, uint32_t vertex_count,
+                      const uint32_t* clusters, uint32_t cluster_count, uint32_t cache_size, float threshold) {
+    uint32_t triangle_count = index_count / 3;
+    if (triangle_count == 0 || cluster_count == 0) return 1;
+
+    CacheModel cache;
+    TriangleCluster* soft = (TriangleCluster*)malloc(triangle_count * sizeof(TriangleCluster));
+    uint32_t* sorted = (uint32_t*)malloc(triangle_count * 3 * sizeof(uint32_t));
+    if (!soft || !sorted || !init_cache_model(&cache, vertex_count, cache_size)) {
+        if (!soft || !sorted) printf("Error: Out of memory\n");
+        free(soft);
+        free(sorted);
+        return 0;
+    }
+
+    // Soft boundaries: inside a hard cluster, cut wherever the part so far already
+    // reaches the cluster's own ACMR (times threshold). Starting a piece with a cold cache
+    // is then cheap, and smaller pieces sort better.
+    uint32_t soft_count = 0;
+    for (uint32_t c = 0; c < cluster_count; c++) {
+        uint32_t start = clusters[c];
+        uint32_t end = c + 1 < cluster_count ? clusters[c + 1] : triangle_count;
+
+        flush_cache(&cache);
+        uint32_t cluster_misses = 0;
+        for (uint32_t i = start * 3; i < end * 3; i++) cluster_misses += touch_cache(&cache, indices[i]);
+        float cluster_acmr = (float)cluster_misses / (float)(end - start);
+
+        flush_cache(&cache);
+        uint32_t piece_start = start, piece_misses = 0;
+        for (uint32_t t = start; t < end; t++) {
+            for (int corner = 0; corner < 3; corner++) piece_misses += touch_cache(&cache, indices[t * 3 + corner]);
+            uint32_t piece_size = t + 1 - piece_start;
+            if (t + 1 == end || (float)piece_misses <= threshold * cluster_acmr * (float)piece_size) {
+                soft[soft_count++] = (TriangleCluster){ piece_start, piece_size, 0.0f };
+                piece_start = t + 1;
+                piece_misses = 0;
+                flush_cache(&cache);
+            }
+        }
+    }
+
+    // Area weighted centroid of the whole range
+    float mesh_centroid[3] = {0.0f, 0.0f, 0.0f};
+    float mesh_area = 0.0f;
+    for (uint32_t t = 0; t < triangle_count; t++) {
+        float centroid[3], normal[3];
+        triangle_centroid_normal(&indices[t * 3], positions, centroid, normal);
+        float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (int k = 0; k < 3; k++) mesh_centroid[k] += centroid[k] * area;
+        mesh_area += area;
+    }
+    if (mesh_area > 0.0f) {
+        for (int k = 0; k < 3; k++) mesh_centroid[k] /= mesh_area;
+    }
+
+    // Clusters far out along their own normal are likely to occlude the rest: draw them first
+    for (uint32_t s = 0; s < soft_count; s++) {
+        float cluster_centroid[3] = {0.0f, 0.0f, 0.0f}, cluster_normal[3] = {0.0f, 0.0f, 0.0f};
+        float cluster_area = 0.0f;
+        for (uint32_t t = soft[s].start; t < soft[s].start + soft[s].count; t++) {
+            float centroid[3], normal[3];
+            triangle_centroid_normal(&indices[t * 3], positions, centroid, normal);
+            float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int k = 0; k < 3; k++) {
+                cluster_centroid[k] += centroid[k] * area;
+                cluster_normal[k] += normal[k];
+            }
+            cluster_area += area;
+        }
+        float length = sqrtf(cluster_normal[0] * cluster_normal[0] + cluster_normal[1] * cluster_normal[1] + cluster_normal[2] * cluster_normal[2]);
+        float key = 0.0f;
+        if (cluster_area > 0.0f && length > 0.0f) {
+            for (int k = 0; k < 3; k++) key += (cluster_centroid[k] / cluster_area - mesh_centroid[k]) * cluster_normal[k] / length;
+        }
+        soft[s].sort_key = key;
+    }
+    qsort(soft, soft_count, sizeof(TriangleCluster), compare_clusters);
+
+    uint32_t output = 0;
+    for (uint32_t s = 0; s < soft_count; s++) {
+        memcpy(&sorted[output], &indices[soft[s].start * 3], soft[s].count * 3 * sizeof(uint32_t));
+        output += soft[s].count * 3;
+    }
+    memcpy(indices, sorted, output * sizeof(uint32_t));
+
+    free(cache.timestamps);
+    free(soft);
+    free(sorted);
+    return 1;
+}
+
+//================================================
+// Vertex fetch
+//================================================
+
+uint32_t optimize_vertex_fetch_remap(uint32_t* remap, uint32_t* indices, uint32_t index_count, uint32_t vertex_count) {
+    for (uint32_t v = 0; v < vertex_count; v++) remap[v] = NO_VERTEX;
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < index_count; i++) {
+        uint32_t vertex = indices[i];
+        if (remap[vertex] == NO_VERTEX) remap[vertex] = next++;
+        indices[i] = remap[vertex];
+    }
+    return next;
+}
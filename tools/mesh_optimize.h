@@ -0,0 +1,35 @@
+// mesh_optimize.h
+#pragma once
+
+// Index and vertex reordering for mesh_cooker. Works on plain 32-bit triangle lists so
+// it does not depend on the cooker's mesh struct.
+
+#include <stdint.h>
+
+// Post-transform cache statistics for a FIFO cache of cache_size entries
+typedef struct {
+    float acmr;     // Cache misses per triangle (0.5 is the best a regular grid gets, 3 is no reuse)
+    float atvr;     // Cache misses per referenced vertex (1 is optimal)
+} MeshCacheStats;
+
+MeshCacheStats analyze_vertex_cache(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count, uint32_t cache_size);
+
+// Tipsify (Sander, Nehab, Barczak 2007): reorder triangles for a cache_size FIFO.
+// Writes the new order to destination (may not alias indices). If clusters is not NULL,
+// it receives the first triangle of every cluster (a point where the walk had to jump
+// to a far vertex), and the count is returned in cluster_count. clusters needs room
+// for index_count / 3 entries.
+int optimize_vertex_cache(uint32_t* destination, const uint32_t* indices, uint32_t index_count, uint32_t vertex_count,
+                          uint32_t cache_size, uint32_t* clusters, uint32_t* cluster_count);
+
+// Split the clusters further where that costs at most threshold times the cluster's ACMR,
+// then sort them so outward facing clusters on the silhouette of the mesh draw first
+// (fast view-independent overdraw ordering from the same paper). indices must already be
+// vertex cache optimized with the given clusters. In place. threshold 1.05 is a good start.
+int optimize_overdraw(uint32_t* indices, uint32_t index_count, const float* positions, uint32_t vertex_count,
+                      const uint32_t* clusters, uint32_t cluster_count, uint32_t cache_size, float threshold);
+
+// Number vertices by first use in the index buffer so fetches walk memory forward.
+// remap[old] gets the new index, or ~0u for vertices no triangle uses. Returns the
+// number of used vertices. The indices are rewritten in place.
+uint32_t optimize_vertex_fetch_remap(uint32_t* remap, uint32_t* indices, uint32_t index_count, uint32_t vertex_count);